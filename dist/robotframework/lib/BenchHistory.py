@@ -0,0 +1,203 @@
+#! /usr/bin/env python3
+# Copyright (C) 2019 HAW Hamburg
+#
+# This file is subject to the terms and conditions of the GNU Lesser
+# General Public License v2.1. See the file LICENSE in the top level
+# directory for more details.
+"""@package PyToAPI
+This module keeps the results of the bench commands per board and RIOT
+version and compares them against a stored baseline.
+
+The history of a board is ``<dir>/<BOARD>/<RIOT_VERSION>.json``, the
+baseline ``<dir>/<BOARD>/baseline.json``. Both map a metric, named
+``SUITE.NAME.FIELD``, to the direction that is better and its values:
+
+    {"tests_periph_spi.Bench 1M Should Succeed.bytes_per_s":
+        {"better": "higher", "values": [51200, 51187]}}
+
+Run as script to compare a version against the baseline or to store the
+median of a version as the new baseline.
+"""
+import argparse
+import fcntl
+import json
+import os
+import re
+import statistics
+import sys
+
+from robot.api import logger
+from robot.libraries.BuiltIn import BuiltIn
+
+BETTER = ('higher', 'lower')
+BASELINE = 'baseline'
+# number of values of a metric kept per RIOT version
+HISTORY_LEN = 50
+
+
+def _file_name(version):
+    """Return a file name for a RIOT version."""
+    return re.sub(r'[^\w.+-]', '_', version) + '.json'
+
+
+def _update(path, func):
+    """Run ``func`` on the content of a json file and store the result.
+
+    The file is locked so benches of the same board can share it.
+    """
+    os.makedirs(os.path.dirname(path), exist_ok=True)
+    with open(path, 'a+') as json_file:
+        fcntl.flock(json_file, fcntl.LOCK_EX)
+        json_file.seek(0)
+        content = json_file.read()
+        data = func(json.loads(content) if content else {})
+        json_file.seek(0)
+        json_file.truncate()
+        json.dump(data, json_file, indent=2, sort_keys=True)
+    return data
+
+
+def _load(path):
+    """Return the content of a json file or an empty dict."""
+    if not os.path.exists(path):
+        return {}
+    with open(path) as json_file:
+        return json.load(json_file)
+
+
+def regression(metric, value, base, tolerance):
+    """Return how much worse a value is than the baseline in percent.
+
+    Returns None if it is within the tolerance.
+    """
+    ref = base['values'][-1]
+    if metric['better'] == 'higher':
+        worse = ref - value
+    else:
+        worse = value - ref
+    if worse <= 0:
+        return None
+    if ref == 0:
+        return float('inf')
+    percent = 100.0 * worse / abs(ref)
+    return percent if percent > tolerance else None
+
+
+class BenchHistory:
+    """Robot framework library to record and check bench results."""
+    ROBOT_LIBRARY_SCOPE = 'GLOBAL'
+
+    def __init__(self, bench_dir, board, riot_version, tolerance=10):
+        self._dir = os.path.join(bench_dir, board)
+        self._history = os.path.join(self._dir, _file_name(riot_version))
+        self._baseline = _load(os.path.join(self._dir,
+                                            _file_name(BASELINE)))
+        self._tolerance = float(tolerance)
+
+    def record_bench_metrics(self, name, stats, *fields):
+        """Store fields of a bench result and fail if one regressed.
+
+        Each field is ``PATH:higher`` or ``PATH:lower``, where ``PATH`` is
+        the key in ``stats``, with ``.`` for nested keys, and the suffix
+        tells which direction is better. The values are compared against
+        the baseline with the tolerance in percent.
+        """
+        suite = BuiltIn().get_variable_value('${SUITE NAME}')
+        metrics = {}
+        for field in fields:
+            path, _, better = field.rpartition(':')
+            if better not in BETTER:
+                raise ValueError('Expected FIELD:higher or FIELD:lower, '
+                                 'got {}'.format(field))
+            value = stats
+            for key in path.split('.'):
+                value = value[key]
+            metrics['{}.{}.{}'.format(suite, name, path)] = {
+                'better': better, 'value': float(value)}
+
+        def _append(history):
+            for key, metric in metrics.items():
+                entry = history.setdefault(key, {'values': []})
+                entry['better'] = metric['better']
+                entry['values'] = (entry['values']
+                                   + [metric['value']])[-HISTORY_LEN:]
+            return history
+        _update(self._history, _append)
+
+        failed = []
+        for key, metric in sorted(metrics.items()):
+            base = self._baseline.get(key)
+            if base is None:
+                logger.info('{}: {} (no baseline)'.format(key,
+                                                          metric['value']))
+                continue
+            worse = regression(metric, metric['value'], base,
+                               self._tolerance)
+            logger.info('{}: {} (baseline {})'.format(key, metric['value'],
+                                                      base['values'][-1]))
+            if worse is not None:
+                failed.append('{} is {} ({:.1f}% worse than {})'.format(
+                    key, metric['value'], worse, base['values'][-1]))
+        if failed:
+            raise AssertionError('Bench regression: ' + ', '.join(failed))
+
+
+def compare(args):
+    """Print the metrics of a version that are worse than the baseline."""
+    board_dir = os.path.join(args.dir, args.board)
+    history = _load(os.path.join(board_dir, _file_name(args.version)))
+    baseline = _load(os.path.join(board_dir, _file_name(BASELINE)))
+    failed = 0
+    for key, metric in sorted(history.items()):
+        value = statistics.median(metric['values'])
+        base = baseline.get(key)
+        if base is None:
+            print('NEW   {}: {}'.format(key, value))
+            continue
+        worse = regression(metric, value, base, args.tolerance)
+        if worse is None:
+            print('OK    {}: {} (baseline {})'.format(
+                key, value, base['values'][-1]))
+        else:
+            failed += 1
+            print('WORSE {}: {} ({:.1f}% worse than {})'.format(
+                key, value, worse, base['values'][-1]))
+    return 1 if failed else 0
+
+
+def baseline(args):
+    """Store the median of each metric of a version as the baseline."""
+    board_dir = os.path.join(args.dir, args.board)
+    history = _load(os.path.join(board_dir, _file_name(args.version)))
+    if not history:
+        print('No bench results of {} for {}'.format(args.version,
+                                                     args.board))
+        return 1
+
+    def _set(base):
+        for key, metric in history.items():
+            base[key] = {'better': metric['better'],
+                         'values': [statistics.median(metric['values'])],
+                         'version': args.version}
+        return base
+    _update(os.path.join(board_dir, _file_name(BASELINE)), _set)
+    print('Stored {} metrics of {} as baseline for {}'.format(
+        len(history), args.version, args.board))
+    return 0
+
+
+def main():
+    """Compare or store the bench results of a RIOT version."""
+    parser = argparse.ArgumentParser(description=main.__doc__)
+    parser.add_argument('action', choices=['compare', 'baseline'])
+    parser.add_argument('dir', help='directory of the bench history')
+    parser.add_argument('board')
+    parser.add_argument('version', help='RIOT version of the results')
+    parser.add_argument('-t', '--tolerance', type=float, default=10,
+                        help='allowed regression in percent')
+    args = parser.parse_args()
+    return {'compare': compare, 'baseline': baseline}[args.action](args)
+
+
+if __name__ == '__main__':
+    sys.exit(main())
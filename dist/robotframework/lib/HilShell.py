@@ -0,0 +1,417 @@
+# Copyright (C) 2019 HAW Hamburg
+#
+# This file is subject to the terms and conditions of the GNU Lesser
+# General Public License v2.1. See the file LICENSE in the top level
+# directory for more details.
+"""@package PyToAPI
+This module extends the riot_pal DutShell with the output formats of the
+test_helpers that riot_pal does not know about.
+"""
+import json
+import logging
+import os
+import re
+import struct
+import time
+
+from riot_pal import DutShell
+
+BIN_FRAME_SOF = 0xB5
+BIN_FRAME_FLAG_LAST = 0x01
+BIN_FRAME_HDR_LEN = 4
+BIN_FRAME_CRC_LEN = 2
+
+CRC16_CCITT_INIT = 0xFFFF
+CRC16_CCITT_POLY = 0x1021
+
+# a print_data_dict_int entry of the plain output
+RE_PLAIN_DICT = re.compile(r'^(\w+): (-?\d+)$')
+
+# must match TEST_HELPERS_STDIO_BAUD_CONFIRM and _DRAIN of test_helpers.h
+STDIO_BAUD_CONFIRM = 'stdio_baud_ok'
+STDIO_BAUD_DRAIN = 64
+
+
+def crc16_ccitt(data, crc=CRC16_CCITT_INIT):
+    """Calculate the CRC-16/CCITT-FALSE used by the BIN_SHELL_PARSER."""
+    for byte in data:
+        crc ^= byte << 8
+        for _ in range(8):
+            if crc & 0x8000:
+                crc = ((crc << 1) ^ CRC16_CCITT_POLY) & 0xFFFF
+            else:
+                crc = (crc << 1) & 0xFFFF
+    return crc
+
+
+def bytes_from_data(data):
+    """Convert a data entry written by print_data_bytes to a list of ints.
+
+    Text parsers write the bytes as a hex string, the binary parser as a
+    byte string.
+    """
+    if isinstance(data, (bytes, bytearray)):
+        return list(data)
+    return list(bytes.fromhex(data))
+
+
+def dict_from_data(data):
+    """Merge data entries written by print_data_dict_* into one dict."""
+    res = {}
+    for entry in data:
+        if isinstance(entry, dict):
+            res.update(entry)
+    return res
+
+
+class _CborBreak:
+    """Marker for the end of an indefinite length CBOR item."""
+
+
+def _cbor_decode(data, idx=0):
+    """Decode the CBOR subset written by the test_helpers.
+
+    Returns the decoded item and the index of the next item.
+    """
+    ib = data[idx]
+    idx += 1
+    major = ib >> 5
+    info = ib & 0x1F
+    if ib == 0xFF:
+        return _CborBreak, idx
+    if info < 24:
+        val = info
+    elif info == 24:
+        val = data[idx]
+        idx += 1
+    elif info == 25:
+        val = struct.unpack_from('>H', data, idx)[0]
+        idx += 2
+    elif info == 26:
+        val = struct.unpack_from('>I', data, idx)[0]
+        idx += 4
+    elif info == 27:
+        val = struct.unpack_from('>Q', data, idx)[0]
+        idx += 8
+    elif info == 31:
+        val = None
+    else:
+        raise ValueError('Invalid CBOR additional info {}'.format(info))
+
+    if major == 0:
+        return val, idx
+    if major == 1:
+        return -1 - val, idx
+    if major in (2, 3):
+        raw = bytes(data[idx:idx + val])
+        idx += val
+        return (raw if major == 2 else raw.decode('utf-8', 'replace')), idx
+    if major == 4:
+        items = []
+        while val is None or len(items) < val:
+            item, idx = _cbor_decode(data, idx)
+            if item is _CborBreak:
+                break
+            items.append(item)
+        return items, idx
+    if major == 5:
+        items = {}
+        while val is None or len(items) < val:
+            key, idx = _cbor_decode(data, idx)
+            if key is _CborBreak:
+                break
+            items[key], idx = _cbor_decode(data, idx)
+        return items, idx
+    if major == 7:
+        return {20: False, 21: True, 22: None}.get(info), idx
+    raise ValueError('Unsupported CBOR major type {}'.format(major))
+
+
+class BinFrameDecoder:
+    """Reassembles BIN_SHELL_PARSER responses from a stream of bytes."""
+
+    def __init__(self):
+        self._rx = bytearray()
+        self._payload = bytearray()
+        self.crc_errors = 0
+
+    def reset(self):
+        """Drop any partially received response."""
+        self._rx = bytearray()
+        self._payload = bytearray()
+
+    def feed(self, data):
+        """Add received bytes and return the list of completed responses."""
+        self._rx += data
+        responses = []
+        while True:
+            sof = self._rx.find(bytes([BIN_FRAME_SOF]))
+            if sof < 0:
+                # everything else is shell echo or prompt
+                self._rx = bytearray()
+                break
+            del self._rx[:sof]
+            if len(self._rx) < BIN_FRAME_HDR_LEN:
+                break
+            flags = self._rx[1]
+            length = self._rx[2] | (self._rx[3] << 8)
+            frame_len = BIN_FRAME_HDR_LEN + length + BIN_FRAME_CRC_LEN
+            if len(self._rx) < frame_len:
+                break
+            end = BIN_FRAME_HDR_LEN + length
+            crc = self._rx[end] | (self._rx[end + 1] << 8)
+            if crc != crc16_ccitt(self._rx[1:end]):
+                # false start of frame, resync on the next SOF
+                logging.debug("BIN frame CRC mismatch")
+                self.crc_errors += 1
+                del self._rx[:1]
+                continue
+            self._payload += self._rx[BIN_FRAME_HDR_LEN:end]
+            del self._rx[:frame_len]
+            if flags & BIN_FRAME_FLAG_LAST:
+                responses.append(_cbor_decode(self._payload)[0])
+                self._payload = bytearray()
+        return responses
+
+
+class HilShell(DutShell):
+    """Interface to a node that uses the test_helpers for its output."""
+
+    RESULT_TIMEOUT = 'Timeout'
+
+    # Namespace of the commands in the combined firmware of all tests
+    NAMESPACE = None
+
+    def __init__(self, *args, **kwargs):
+        parser = kwargs.pop('parser', None)
+        self.parser = parser or 'json'
+        self._bin_decoder = None
+        if parser == 'bin':
+            self._bin_decoder = BinFrameDecoder()
+        elif parser and parser != 'plain':
+            kwargs['parser'] = parser
+        self._cmd_timeout = kwargs.get('timeout', 1)
+        self._baudrate = int(kwargs.get('baudrate', 115200))
+        self._stdio_bauds = [int(baud) for baud in
+                             os.environ.get('HIL_STDIO_BAUDS', '').split()]
+        self._cmd_prefix = ''
+        if self.NAMESPACE and os.environ.get('HIL_COMBINED') == '1':
+            self._cmd_prefix = self.NAMESPACE + ' '
+        super().__init__(*args, **kwargs)
+
+    def _read_raw(self):
+        """Read the available raw bytes from the serial port of the driver."""
+        dev = self._driver._dev
+        return dev.read(max(1, dev.in_waiting))
+
+    def _read_bin_response(self, timeout):
+        """Wait for the next complete BIN_SHELL_PARSER response."""
+        deadline = time.time() + float(timeout)
+        while time.time() < deadline:
+            responses = self._bin_decoder.feed(self._read_raw())
+            if responses:
+                res = responses[-1]
+                logging.debug("Response: {}".format(res))
+                return res
+        return None
+
+    def _send_bin_cmd(self, send_cmd, timeout=None):
+        """Send a command and decode the BIN_SHELL_PARSER response."""
+        if timeout is None:
+            timeout = self._cmd_timeout
+        self._bin_decoder.reset()
+        self._write(send_cmd)
+        res = self._read_bin_response(timeout)
+        if res is None:
+            return {'cmd': send_cmd, 'result': self.RESULT_TIMEOUT}
+        return res
+
+    def _read_lines(self, done, timeout):
+        """Collect lines until one starts with one of ``done``.
+
+        Returns the lines and whether a ``done`` line was received before
+        nothing arrived for ``timeout`` seconds.
+        """
+        lines = []
+        rx = bytearray()
+        deadline = time.time() + float(timeout)
+        while time.time() < deadline:
+            data = self._read_raw()
+            if not data:
+                continue
+            deadline = time.time() + float(timeout)
+            rx += data
+            while b'\n' in rx:
+                line, _, rx = rx.partition(b'\n')
+                line = line.decode('utf-8', 'replace').strip()
+                logging.debug("Line: {}".format(line))
+                lines.append(line)
+                if line.startswith(done):
+                    return lines, True
+        return lines, False
+
+    def send_cmd_lines(self, send_cmd, done=('Success', 'Error'),
+                       timeout=None):
+        """Send a command and collect its output lines.
+
+        Reading stops at the first line starting with one of ``done`` or
+        when nothing was received for ``timeout`` seconds, so commands that
+        stream many lines are not limited by the command timeout.
+        """
+        if timeout is None:
+            timeout = self._cmd_timeout
+        self._write(self._cmd_prefix + send_cmd)
+        lines, complete = self._read_lines(done, timeout)
+        if not complete:
+            lines.append(self.RESULT_TIMEOUT)
+        return lines
+
+    def send_bytes_cmd(self, send_cmd, timeout=None):
+        """Send a command that replies with a single print_data_bytes entry.
+
+        The data of a successful response is replaced by the list of bytes.
+        """
+        res = self.send_cmd(send_cmd, timeout)
+        data = res.get('data')
+        if data and len(data) == 1 and not isinstance(data[0], (int, list)):
+            res['data'] = bytes_from_data(data[0])
+        return res
+
+    def batch(self, *cmds, stop_on_error=False, timeout=None):
+        """Run several shell commands on the node with one round trip.
+
+        The data of the response holds the response of each command.
+        """
+        line = ' ; '.join(cmds)
+        if stop_on_error:
+            line = '-e ' + line
+        return self.send_cmd('batch ' + line, timeout)
+
+    def profile(self, reset=False, timeout=None):
+        """Get the number of calls and total duration of each command.
+
+        Needs a firmware built with ``USE_CMD_DURATION=1``. The data of a
+        successful response is replaced by a dict of ``NAME_count`` and
+        ``NAME_us`` entries.
+        """
+        res = self.send_cmd('profile reset' if reset else 'profile', timeout)
+        if res.get('result') == 'Success':
+            res['data'] = dict_from_data(res.get('data', []))
+        return res
+
+    def mem_stats(self, timeout=None):
+        """Get the stack high-water marks and the static buffer sizes.
+
+        The data of a successful response is replaced by a dict of
+        ``NAME_stack_size``, ``NAME_stack_used``, ``NAME_size``,
+        ``scratch_max_used`` and ``static_total`` entries.
+        """
+        if self.parser == 'plain':
+            lines = self.send_cmd_lines('mem_stats', timeout=timeout)
+            data = [{m.group(1): int(m.group(2))} for m in
+                    (RE_PLAIN_DICT.match(line) for line in lines[:-1]) if m]
+            res = {'cmd': 'mem_stats()', 'data': data, 'result': lines[-1]}
+        else:
+            res = self.send_cmd('mem_stats', timeout)
+        if res.get('result') == 'Success':
+            res['data'] = dict_from_data(res.get('data', []))
+        return res
+
+    def timer_width(self, dev=0, bits=None, timeout=None):
+        """Measure or set the counter width of a periph timer of the node.
+
+        Without ``bits`` the node reads the initialized timer until it wraps,
+        ``timeout`` has to cover that time. The data is the width in bit.
+        """
+        send_cmd = 'timer_width {}'.format(dev)
+        if bits is not None:
+            send_cmd += ' {}'.format(int(bits))
+        if self.parser == 'plain':
+            lines = self.send_cmd_lines(send_cmd, timeout=timeout)
+            data = [int(line) for line in lines[:-1] if line.isdigit()]
+            res = {'cmd': 'timer_width()', 'data': data, 'result': lines[-1]}
+        else:
+            res = self.send_cmd(send_cmd, timeout)
+        return res
+
+    def _read_response(self, cmd, timeout):
+        """Read a response the node prints without a command of the host."""
+        if self._bin_decoder is not None:
+            res = self._read_bin_response(timeout)
+            return res or {'cmd': cmd, 'result': self.RESULT_TIMEOUT}
+        # the JSON parser prints one line, the others end with the result
+        lines, complete = self._read_lines(('Success', 'Error', '{'),
+                                           timeout)
+        if not complete:
+            return {'cmd': cmd, 'result': self.RESULT_TIMEOUT}
+        if lines[-1].startswith('{'):
+            try:
+                return json.loads(lines[-1])
+            except ValueError:
+                return {'cmd': cmd, 'data': lines, 'result': 'Error'}
+        return {'cmd': cmd, 'data': lines[:-1], 'result': lines[-1]}
+
+    def _set_host_baud(self, baud):
+        """Change the rate of the serial port and drop what was received."""
+        dev = self._driver._dev
+        dev.baudrate = int(baud)
+        dev.reset_input_buffer()
+        if self._bin_decoder is not None:
+            self._bin_decoder.reset()
+
+    def reset_stdio_baud(self):
+        """Go back to the default rate, the node uses it after a reset."""
+        self._set_host_baud(self._baudrate)
+
+    def stdio_baud(self, baud, timeout=1):
+        """Switch the stdio UART of the node and the host to another rate.
+
+        Needs a firmware built with ``USE_STDIO_BAUD=1``. The node only
+        keeps the new rate if the host confirms it within ``timeout``
+        seconds, otherwise both fall back to the previous rate.
+        """
+        baud = int(baud)
+        timeout = float(timeout)
+        old = self._driver._dev.baudrate
+        send_cmd = 'stdio_baud {} {}'.format(baud, int(timeout * 1000))
+        if self.parser == 'plain':
+            lines = self.send_cmd_lines(send_cmd)
+            res = {'cmd': 'stdio_baud()', 'data': lines[:-1],
+                   'result': lines[-1]}
+        else:
+            res = self.send_cmd(send_cmd)
+        if res.get('result') != 'Success':
+            return res
+        # the node lets its response drain before it changes the rate
+        time.sleep(STDIO_BAUD_DRAIN * 10 / old)
+        self._set_host_baud(baud)
+        self._write(STDIO_BAUD_CONFIRM)
+        res = self._read_response('stdio_baud_confirm()', timeout)
+        if res.get('result') != 'Success':
+            self._set_host_baud(old)
+            # the node prints the fallback confirmation at the old rate
+            self._read_response('stdio_baud_confirm()', timeout)
+        return res
+
+    def negotiate_stdio_baud(self):
+        """Switch to the highest rate of HIL_STDIO_BAUDS that works.
+
+        Does nothing if HIL_STDIO_BAUDS is empty, so the default rate is
+        kept for firmwares without the stdio_baud command.
+        """
+        for baud in sorted(self._stdio_bauds, reverse=True):
+            if baud <= self._baudrate:
+                continue
+            res = self.stdio_baud(baud)
+            if res.get('result') == 'Success':
+                return res
+            logging.info("stdio_baud {} failed: {}".format(baud, res))
+        return {'cmd': 'stdio_baud_confirm()',
+                'data': [self._driver._dev.baudrate], 'result': 'Success'}
+
+    def send_cmd(self, send_cmd, timeout=None):
+        """Returns packet based on the shell output from a command."""
+        send_cmd = self._cmd_prefix + send_cmd
+        if self._bin_decoder is not None:
+            return self._send_bin_cmd(send_cmd, timeout)
+        return super().send_cmd(send_cmd, timeout)
@@ -0,0 +1,135 @@
+#! /usr/bin/env python3
+# Copyright (C) 2019 HAW Hamburg
+#
+# This file is subject to the terms and conditions of the GNU Lesser
+# General Public License v2.1. See the file LICENSE in the top level
+# directory for more details.
+"""Print the text, data and bss size of the test applications per board.
+
+Every application is built for every board, the sizes come from the RIOT
+info-buildsize target. Applications that cannot be built for a board, for
+example because of a missing feature, are listed as failed. The table can
+also be written as CSV to compare it between versions:
+
+    test                board           text    data     bss     rom     ram
+    tests/periph_uart   samr21-xpro    23436     140    5428   23576    5568
+"""
+import argparse
+import concurrent.futures
+import csv
+import glob
+import logging
+import os
+import subprocess
+import sys
+
+from run_boards import MAKE_ENV, TESTBASE, known_boards
+
+FIELDS = ('text', 'data', 'bss', 'rom', 'ram')
+
+
+def default_tests():
+    """Return all test applications."""
+    return sorted(os.path.relpath(os.path.dirname(makefile), TESTBASE)
+                  for makefile in glob.glob(os.path.join(TESTBASE, 'tests',
+                                                         '*', 'Makefile')))
+
+
+def _make(test, board, targets):
+    """Run make for a board, returns the exit code and the output."""
+    cmd = ['make', '-s', '--no-print-directory', '-C',
+           os.path.join(TESTBASE, test), 'BOARD={}'.format(board)] + targets
+    # the variables of a calling make must not leak into the other boards
+    env = {k: v for k, v in os.environ.items() if k not in MAKE_ENV}
+    proc = subprocess.run(cmd, stdout=subprocess.PIPE,
+                          stderr=subprocess.STDOUT, env=env,
+                          universal_newlines=True)
+    return proc.returncode, proc.stdout
+
+
+def parse_size(output):
+    """Parse the last line of the size output, returns a dict or None."""
+    for line in reversed(output.splitlines()):
+        fields = line.split()
+        if len(fields) >= 3 and all(f.isdigit() for f in fields[:3]):
+            text, data, bss = (int(f) for f in fields[:3])
+            return {'text': text, 'data': data, 'bss': bss,
+                    'rom': text + data, 'ram': data + bss}
+    return None
+
+
+def build_size(test, board):
+    """Build a test for a board and return its sizes or None on failure."""
+    res, output = _make(test, board, ['all'])
+    if res:
+        logging.debug('%s %s:\n%s', test, board, output)
+        logging.warning('%s: building %s failed', board, test)
+        return None
+    res, output = _make(test, board, ['info-buildsize'])
+    size = parse_size(output) if res == 0 else None
+    if size is None:
+        logging.warning('%s: no size of %s', board, test)
+    return size
+
+
+def print_table(results):
+    """Print the sizes as an aligned table."""
+    test_len = max([len('test')] + [len(t) for t, _ in results])
+    board_len = max([len('board')] + [len(b) for _, b in results])
+    row = '{:<{}}  {:<{}}' + '  {:>7}' * len(FIELDS)
+    print(row.format('test', test_len, 'board', board_len, *FIELDS))
+    for (test, board), size in sorted(results.items()):
+        if size:
+            values = [size[f] for f in FIELDS]
+        else:
+            values = ['failed'] + [''] * (len(FIELDS) - 1)
+        print(row.format(test, test_len, board, board_len, *values).rstrip())
+
+
+def write_csv(results, path):
+    """Write the sizes of the successful builds to a CSV file."""
+    with open(path, 'w', newline='') as csv_file:
+        writer = csv.writer(csv_file)
+        writer.writerow(('test', 'board') + FIELDS)
+        for (test, board), size in sorted(results.items()):
+            if size:
+                writer.writerow([test, board] + [size[f] for f in FIELDS])
+
+
+def main():
+    """Build all tests for all boards and print their sizes."""
+    parser = argparse.ArgumentParser(description=__doc__.split('\n')[0])
+    parser.add_argument('tests', nargs='*',
+                        help='test directories, default all')
+    parser.add_argument('-b', '--boards', nargs='+', default=None,
+                        help='boards to build for, default all in '
+                             'dist/etc/conf')
+    parser.add_argument('-j', '--jobs', type=int, default=os.cpu_count(),
+                        help='number of builds at once')
+    parser.add_argument('-o', '--csv', default=None,
+                        help='also write the sizes to this CSV file')
+    parser.add_argument('-v', '--verbose', action='store_true',
+                        help='log the output of failed builds')
+    args = parser.parse_args()
+    logging.basicConfig(level=logging.DEBUG if args.verbose else logging.INFO,
+                        format='%(message)s')
+
+    boards = args.boards or known_boards()
+    tests = args.tests or default_tests()
+    # an application builds into bin/<BOARD>, so the builds can overlap
+    jobs = [(test, board) for board in boards for test in tests]
+    results = {}
+    with concurrent.futures.ThreadPoolExecutor(
+            max_workers=max(1, args.jobs)) as pool:
+        for job, size in zip(jobs, pool.map(lambda j: build_size(*j), jobs)):
+            results[job] = size
+
+    print_table(results)
+    if args.csv:
+        write_csv(results, args.csv)
+    # boards without the features of a test fail, only fail if none built
+    return 0 if any(results.values()) else 1
+
+
+if __name__ == '__main__':
+    sys.exit(main())
@@ -0,0 +1,210 @@
+#! /usr/bin/env python3
+# Copyright (C) 2019 HAW Hamburg
+#
+# This file is subject to the terms and conditions of the GNU Lesser
+# General Public License v2.1. See the file LICENSE in the top level
+# directory for more details.
+"""Run the robot tests on several boards at once.
+
+Each line of the bench file describes one test bench, the board and the
+serial ports of the DUT and of PHiLIP, optionally followed by make
+variables for that bench:
+
+    # BOARD         PORT            PHILIP_PORT     [VAR=VALUE]...
+    nucleo-f411re   /dev/ttyACM0    /dev/ttyUSB0
+    samr21-xpro     /dev/ttyACM1    /dev/ttyUSB1    SERIAL=ATML2127031800004957
+
+The benches run in parallel, the tests of a board are spread over the
+benches of that board. The results of all boards are merged at the end,
+with one suite per board.
+"""
+import argparse
+import concurrent.futures
+import glob
+import logging
+import os
+import queue
+import subprocess
+import sys
+import time
+
+TESTBASE = os.path.abspath(os.path.join(os.path.dirname(__file__),
+                                        '..', '..', '..'))
+CONF_DIR = os.path.join(TESTBASE, 'dist', 'etc', 'conf')
+RF_BUILD_DIR = os.path.join(TESTBASE, 'build', 'robot')
+
+# robot and rebot return the number of failed tests up to this value
+ROBOT_RC_MAX_FAILED = 250
+
+MAKE_ENV = ('MAKEFLAGS', 'MFLAGS', 'MAKELEVEL', 'MAKEOVERRIDES')
+
+
+def known_boards():
+    """Return the boards with an env file in dist/etc/conf."""
+    return sorted(os.path.splitext(os.path.basename(env))[0]
+                  for env in glob.glob(os.path.join(CONF_DIR, '*.env'))
+                  if not env.endswith('default.env'))
+
+
+def read_benches(path):
+    """Read the bench file, returns a list of dicts of make variables."""
+    benches = []
+    with open(path) as bench_file:
+        for num, line in enumerate(bench_file, 1):
+            fields = line.split('#', 1)[0].split()
+            if not fields:
+                continue
+            if len(fields) < 3:
+                raise ValueError('{}:{}: expected BOARD PORT PHILIP_PORT'
+                                 .format(path, num))
+            bench = {'BOARD': fields[0], 'PORT': fields[1],
+                     'PHILIP_PORT': fields[2]}
+            for var in fields[3:]:
+                key, sep, val = var.partition('=')
+                if not sep:
+                    raise ValueError('{}:{}: expected VAR=VALUE, got {}'
+                                     .format(path, num, var))
+                bench[key] = val
+            benches.append(bench)
+    return benches
+
+
+def default_tests():
+    """Return the test applications that have robot tests."""
+    return sorted(os.path.relpath(os.path.dirname(tests), TESTBASE)
+                  for tests in glob.glob(os.path.join(TESTBASE, 'tests',
+                                                      '*', 'tests')))
+
+
+def _make(test, bench, targets, log):
+    """Run make for the bench, returns the exit code."""
+    cmd = ['make', '-C', os.path.join(TESTBASE, test)]
+    cmd += ['{}={}'.format(k, v) for k, v in sorted(bench.items())]
+    cmd += targets
+    # the variables of a calling make must not leak into the other boards
+    env = {k: v for k, v in os.environ.items() if k not in MAKE_ENV}
+    log.write('$ {}\n'.format(' '.join(cmd)))
+    log.flush()
+    return subprocess.call(cmd, stdout=log, stderr=subprocess.STDOUT,
+                           env=env)
+
+
+def run_bench(bench, tests):
+    """Flash and run the tests from the queue on a bench.
+
+    Benches of the same board share the queue, so their tests are spread
+    over them. Returns the list of robot output files and the list of
+    tests whose flash or robot run failed without an output.
+    """
+    board = bench['BOARD']
+    board_dir = os.path.join(RF_BUILD_DIR, board)
+    os.makedirs(board_dir, exist_ok=True)
+    log_name = 'run_boards_{}.log'.format(os.path.basename(bench['PORT']))
+    outputs = []
+    failures = []
+    with open(os.path.join(board_dir, log_name), 'w') as log:
+        while True:
+            try:
+                test = tests.get_nowait()
+            except queue.Empty:
+                break
+            app = 'tests_' + os.path.basename(test)
+            env = dict(bench, RFOUTPATH=os.path.join(board_dir, app))
+            start = time.time()
+            _make(test, env, ['robot-clean'], log)
+            if _make(test, env, ['flash'], log):
+                logging.error('%s: flashing %s failed', board, test)
+                failures.append('{} (flash)'.format(test))
+                continue
+            res = _make(test, env, ['robot-test'], log)
+            logging.info('%s: %s %s after %.0f s', board, test,
+                         'passed' if res == 0 else 'failed',
+                         time.time() - start)
+            output = os.path.join(env['RFOUTPATH'], 'output.xml')
+            if os.path.exists(output):
+                outputs.append(output)
+            else:
+                logging.error('%s: %s left no robot output', board, test)
+                failures.append('{} (no output)'.format(test))
+    return outputs, failures
+
+
+def _rebot(name, outdir, outputs, *args):
+    """Merge robot outputs into a suite of the given name."""
+    cmd = [sys.executable, '-m', 'robot.rebot', '--name', name,
+           '-d', outdir, '-o', 'output.xml'] + list(args) + outputs
+    res = subprocess.call(cmd)
+    if res > ROBOT_RC_MAX_FAILED:
+        raise RuntimeError('rebot failed with {}'.format(res))
+    return res
+
+
+def merge(outputs, outdir):
+    """Merge the robot outputs of all boards into one report and xunit."""
+    boards = []
+    for board, board_outputs in sorted(outputs.items()):
+        if not board_outputs:
+            continue
+        board_dir = os.path.join(RF_BUILD_DIR, board)
+        _rebot(board, board_dir, board_outputs, '-l', 'NONE', '-r', 'NONE')
+        boards.append(os.path.join(board_dir, 'output.xml'))
+    return _rebot('HIL', outdir, boards, '--xunit', 'xunit.xml')
+
+
+def main():
+    """Run the tests on all benches in parallel and merge the results."""
+    parser = argparse.ArgumentParser(description=__doc__.split('\n')[0])
+    parser.add_argument('benches', help='file listing the test benches')
+    parser.add_argument('tests', nargs='*',
+                        help='test directories, default all with robot tests')
+    parser.add_argument('-j', '--jobs', type=int, default=0,
+                        help='number of benches run at once, default all')
+    parser.add_argument('-b', '--boards', nargs='+', default=None,
+                        help='only run the benches of these boards')
+    parser.add_argument('-o', '--outdir', default=RF_BUILD_DIR,
+                        help='directory of the merged results')
+    args = parser.parse_args()
+    logging.basicConfig(level=logging.INFO, format='%(message)s')
+
+    boards = known_boards()
+    benches = read_benches(args.benches)
+    if args.boards:
+        benches = [b for b in benches if b['BOARD'] in args.boards]
+    for bench in benches:
+        if bench['BOARD'] not in boards:
+            logging.warning('%s: no env file in %s, using default.env',
+                            bench['BOARD'], CONF_DIR)
+    if not benches:
+        logging.error('No test bench to run')
+        return 1
+    tests = args.tests or default_tests()
+    jobs = args.jobs or len(benches)
+
+    # one queue of tests per board, shared by the benches of the board
+    queues = {}
+    for bench in benches:
+        if bench['BOARD'] not in queues:
+            queues[bench['BOARD']] = queue.Queue()
+            for test in tests:
+                queues[bench['BOARD']].put(test)
+
+    outputs = {}
+    failures = {}
+    with concurrent.futures.ThreadPoolExecutor(max_workers=jobs) as pool:
+        for bench, (res, failed) in zip(benches, pool.map(
+                lambda b: run_bench(b, queues[b['BOARD']]), benches)):
+            outputs.setdefault(bench['BOARD'], []).extend(res)
+            failures.setdefault(bench['BOARD'], []).extend(failed)
+    # these runs are missing in the merged xunit, so they are listed here
+    for board, failed in sorted(failures.items()):
+        if failed:
+            logging.error('%s: not run: %s', board, ', '.join(failed))
+    if not any(outputs.values()):
+        logging.error('No test produced an output')
+        return 1
+    res = merge(outputs, args.outdir)
+    return 1 if res or any(failures.values()) else 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
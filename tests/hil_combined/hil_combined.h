@@ -0,0 +1,47 @@
+/*
+ * Copyright (C) 2019 HAW Hamburg
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+/**
+ * @ingroup tests
+ * @{
+ *
+ * @file
+ * @brief       Export of the shell commands of a test to the combined firmware
+ *
+ * With HIL_COMBINED the test applications do not define main() but export
+ * their shell commands with HIL_COMBINED_APP(). The combined firmware runs
+ * them as "NAMESPACE CMD [ARGS]".
+ *
+ * @}
+ */
+
+#ifndef HIL_COMBINED_H
+#define HIL_COMBINED_H
+
+#include "shell.h"
+
+/**
+ * @brief   Shell commands of a test application
+ */
+typedef struct {
+    const char *name;                   /**< namespace of the commands */
+    const shell_command_t *commands;    /**< commands of the application */
+    void (*init)(void);                 /**< called once at boot or NULL */
+} hil_combined_app_t;
+
+/**
+ * @brief   Exports the shell commands of a test application
+ *
+ * @param[in] ns        namespace of the commands, e.g. spi
+ * @param[in] cmds      the shell_command_t array of the application
+ * @param[in] init_fn   function to call once at boot or NULL
+ */
+#define HIL_COMBINED_APP(ns, cmds, init_fn) \
+    const hil_combined_app_t hil_combined_app_ ## ns = { #ns, cmds, init_fn }
+
+#endif /* HIL_COMBINED_H */
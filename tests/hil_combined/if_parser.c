@@ -0,0 +1,19 @@
+/*
+ * Copyright (C) 2019 HAW Hamburg
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+/**
+ * @ingroup tests
+ * @{
+ *
+ * @file
+ * @brief       Shell commands of the if_parser test in the combined firmware
+ *
+ * @}
+ */
+
+#include "../if_parser/main.c"
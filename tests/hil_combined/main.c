@@ -0,0 +1,127 @@
+/*
+ * Copyright (C) 2019 HAW Hamburg
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+/**
+ * @ingroup tests
+ * @{
+ *
+ * @file
+ * @brief       Combined firmware with the shell commands of all tests
+ *
+ * The commands of each test are run with the namespace of the test as
+ * prefix, e.g. "spi spi_init 0" or "i2c i2c_acquire 0".
+ *
+ * @}
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include "shell.h"
+
+#include "hil_combined.h"
+#include "test_helpers.h"
+
+/* the shell line buffer has to hold the namespace in addition to the command */
+#ifndef HIL_COMBINED_BUFSIZE
+#define HIL_COMBINED_BUFSIZE    (256U)
+#endif
+
+#ifdef MODULE_PERIPH_SPI
+extern const hil_combined_app_t hil_combined_app_spi;
+#endif
+#ifdef MODULE_PERIPH_I2C
+extern const hil_combined_app_t hil_combined_app_i2c;
+#endif
+#ifdef MODULE_PERIPH_UART
+extern const hil_combined_app_t hil_combined_app_uart;
+#endif
+#ifdef MODULE_PERIPH_GPIO
+extern const hil_combined_app_t hil_combined_app_gpio;
+#endif
+extern const hil_combined_app_t hil_combined_app_xtimer;
+extern const hil_combined_app_t hil_combined_app_parser;
+
+static const hil_combined_app_t *apps[] = {
+#ifdef MODULE_PERIPH_SPI
+    &hil_combined_app_spi,
+#endif
+#ifdef MODULE_PERIPH_I2C
+    &hil_combined_app_i2c,
+#endif
+#ifdef MODULE_PERIPH_UART
+    &hil_combined_app_uart,
+#endif
+#ifdef MODULE_PERIPH_GPIO
+    &hil_combined_app_gpio,
+#endif
+    /* no periph_timer, xtimer keeps TIMER_DEV(0) that it would reinit */
+    &hil_combined_app_xtimer,
+    &hil_combined_app_parser,
+};
+
+#define APPS_NUMOF      (sizeof(apps) / sizeof(apps[0]))
+
+/* one shell command per namespace, terminated by an empty entry */
+static shell_command_t shell_commands[APPS_NUMOF + 1];
+
+static const hil_combined_app_t *_find_app(const char *name)
+{
+    for (unsigned i = 0; i < APPS_NUMOF; i++) {
+        if (strcmp(apps[i]->name, name) == 0) {
+            return apps[i];
+        }
+    }
+    return NULL;
+}
+
+static int _run(int argc, char **argv)
+{
+    const hil_combined_app_t *app = _find_app(argv[0]);
+
+    if (app == NULL) {
+        return -1;
+    }
+    if (argc < 2) {
+        printf("usage: %s CMD [ARGS]\n", argv[0]);
+        for (const shell_command_t *cmd = app->commands; cmd->name; cmd++) {
+            printf("%-20s %s\n", cmd->name, cmd->desc);
+        }
+        return 0;
+    }
+    for (const shell_command_t *cmd = app->commands; cmd->name; cmd++) {
+        if (strcmp(cmd->name, argv[1]) == 0) {
+#ifdef TEST_HELPERS_DURATION
+            return test_helpers_profile_call(cmd, argc - 1, &argv[1]);
+#else
+            return cmd->handler(argc - 1, &argv[1]);
+#endif
+        }
+    }
+    printf("Error: %s has no command %s\n", argv[0], argv[1]);
+    return -1;
+}
+
+int main(void)
+{
+    puts("Start: Combined firmware of all tests");
+
+    for (unsigned i = 0; i < APPS_NUMOF; i++) {
+        shell_commands[i].name = apps[i]->name;
+        shell_commands[i].desc = "Run CMD [ARGS] of the test, lists the commands without CMD";
+        shell_commands[i].handler = _run;
+        if (apps[i]->init) {
+            apps[i]->init();
+        }
+    }
+
+    char line_buf[HIL_COMBINED_BUFSIZE];
+    shell_run(shell_commands, line_buf, HIL_COMBINED_BUFSIZE);
+
+    return 0;
+}
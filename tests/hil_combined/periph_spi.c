@@ -0,0 +1,23 @@
+/*
+ * Copyright (C) 2019 HAW Hamburg
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+/**
+ * @ingroup tests
+ * @{
+ *
+ * @file
+ * @brief       Shell commands of the periph_spi test in the combined firmware
+ *
+ * @}
+ */
+
+#if defined(MODULE_PERIPH_SPI)
+#include "../periph_spi/main.c"
+#else
+typedef int dont_be_pedantic;
+#endif
@@ -21,13 +21,24 @@
 #include <stdio.h>
 #include <stdlib.h>
 
+#include "sc_args.h"
 #include "shell.h"
 #include "test_helpers.h"
+#include "test_scratch.h"
+#include "xtimer.h"
+
+#ifdef HIL_COMBINED
+#include "hil_combined.h"
+#endif
 
 #ifndef PARSER_DEV_NUM
 #define PARSER_DEV_NUM 0
 #endif
 
+/* devices and bytes accepted by test_args */
+#define TEST_ARGS_DEV_NUMOF     (4U)
+#define TEST_ARGS_BYTES_MAX     (16U)
+
 void print_app_metadata(int dev)
 {
     print_cmd(dev,"app_metadata()");
@@ -89,9 +100,88 @@ int cmd_test_data_str(int argc, char **argv)
     return 0;
 }
 
-#ifdef JSON_SHELL_PARSER
+int cmd_test_data_flood(int argc, char **argv)
+{
+    uint32_t num;
+    uint32_t size;
+
+    print_cmd(PARSER_DEV_NUM, "test_data_flood()");
+    if (sc_args_parse(argc, argv, "u32, u32", &num, &size) < 0) {
+        print_data_str(PARSER_DEV_NUM, "usage: test_data_flood N SIZE");
+        print_result(PARSER_DEV_NUM, TEST_RESULT_ERROR);
+        return -1;
+    }
+
+    test_scratch_reset();
+    uint8_t *buf = test_scratch_alloc(size);
+    if (size == 0 || buf == NULL) {
+        print_data_str(PARSER_DEV_NUM, "SIZE exceeds the scratch arena");
+        print_result(PARSER_DEV_NUM, TEST_RESULT_ERROR);
+        return -1;
+    }
+
+    /* every item has its own pattern so the host can detect lost items,
+     * the time does not include writing the last part of the response */
+    uint32_t start = xtimer_now_usec();
+    for (uint32_t i = 0; i < num; i++) {
+        for (uint32_t j = 0; j < size; j++) {
+            buf[j] = (uint8_t)(i + j);
+        }
+        print_data_bytes(PARSER_DEV_NUM, buf, size);
+    }
+    uint32_t flood_us = xtimer_now_usec() - start;
+
+    print_data_dict_int(PARSER_DEV_NUM, "flood_us", (int32_t)flood_us);
+    print_result(PARSER_DEV_NUM, TEST_RESULT_SUCCESS);
+    return 0;
+}
+
+int cmd_test_args(int argc, char **argv)
+{
+    int dev;
+    int32_t num;
+    uint8_t val;
+    const char *str;
+    uint8_t bytes[TEST_ARGS_BYTES_MAX];
+    size_t len = sizeof(bytes);
+
+    print_cmd(PARSER_DEV_NUM, "test_args()");
+    int parsed = sc_args_parse(argc, argv, "dev, s32, u8 | str, bytes",
+                               TEST_ARGS_DEV_NUMOF, &dev, &num, &val, &str,
+                               bytes, &len);
+    if (parsed < 0) {
+        print_data_str(PARSER_DEV_NUM,
+                       "usage: test_args DEV S32 U8 [STR [BYTES]...]");
+        print_result(PARSER_DEV_NUM, TEST_RESULT_ERROR);
+        return -1;
+    }
+
+    /* echo the values, the optional ones only if they were given */
+    print_data_int(PARSER_DEV_NUM, dev);
+    print_data_int(PARSER_DEV_NUM, num);
+    print_data_int(PARSER_DEV_NUM, val);
+    if (parsed > 3) {
+        print_data_str(PARSER_DEV_NUM, (char *)str);
+    }
+    if (parsed > 4) {
+        print_data_bytes(PARSER_DEV_NUM, bytes, len);
+    }
+    print_result(PARSER_DEV_NUM, TEST_RESULT_SUCCESS);
+    return 0;
+}
+
+static int cmd_mem_stats(int argc, char **argv)
+{
+    return test_helpers_mem_stats(PARSER_DEV_NUM, NULL, argc, argv);
+}
+
+#if defined(JSON_SHELL_PARSER) || defined(BIN_SHELL_PARSER)
 /* Needs a forward declaration since we use shell_commands */
-int cmd_help(int argc, char **argv);
+static int cmd_help(int argc, char **argv);
+static int cmd_batch(int argc, char **argv);
+#ifdef TEST_HELPERS_DURATION
+static int cmd_profile(int argc, char **argv);
+#endif
 #endif
 
 static const shell_command_t shell_commands[] = {
@@ -100,15 +190,25 @@ static const shell_command_t shell_commands[] = {
     { "test_cmd", "Test commands", cmd_test_cmd },
     { "test_data_int", "Test integers", cmd_test_data_int },
     { "test_data_str", "Test strings", cmd_test_data_str },
-#ifdef JSON_SHELL_PARSER
+    { "test_data_flood", "Print N items of SIZE bytes as fast as possible", cmd_test_data_flood },
+    { "test_args", "Parse the arguments with sc_args_parse and print them", cmd_test_args },
+    { "mem_stats", "Print the stack and static buffer usage", cmd_mem_stats },
+#ifdef TEST_HELPERS_STDIO_BAUD
+    TEST_HELPERS_STDIO_BAUD_CMD,
+#endif
+#if defined(JSON_SHELL_PARSER) || defined(BIN_SHELL_PARSER)
     { "help", "Print command list", cmd_help },
+    { "batch", "Run several commands separated by ; in one call", cmd_batch },
+#ifdef TEST_HELPERS_DURATION
+    { "profile", "Print call count and total duration of each command", cmd_profile },
+#endif
 #endif
     { NULL, NULL, NULL }
 };
 
 
-#ifdef JSON_SHELL_PARSER
-int cmd_help(int argc, char **argv)
+#if defined(JSON_SHELL_PARSER) || defined(BIN_SHELL_PARSER)
+static int cmd_help(int argc, char **argv)
 {
     (void)argc;
     (void)argv;
@@ -118,15 +218,36 @@ int cmd_help(int argc, char **argv)
     print_result(PARSER_DEV_NUM, TEST_RESULT_SUCCESS);
     return 0;
 }
+
+static int cmd_batch(int argc, char **argv)
+{
+    return test_helpers_batch(PARSER_DEV_NUM, shell_commands, argc, argv);
+}
+
+#ifdef TEST_HELPERS_DURATION
+static int cmd_profile(int argc, char **argv)
+{
+    return test_helpers_profile(PARSER_DEV_NUM, shell_commands, argc, argv);
+}
+#endif
 #endif
 
 
+#ifdef HIL_COMBINED
+HIL_COMBINED_APP(parser, shell_commands, NULL);
+#else
 int main(void)
 {
     puts("Running app_metadata test firmware\n");
 
     char line_buf[SHELL_DEFAULT_BUFSIZE];
+#ifdef TEST_HELPERS_DURATION
+    shell_run(test_helpers_profile_commands(shell_commands), line_buf,
+              SHELL_DEFAULT_BUFSIZE);
+#else
     shell_run(shell_commands, line_buf, SHELL_DEFAULT_BUFSIZE);
+#endif
 
     return 0;
 }
+#endif
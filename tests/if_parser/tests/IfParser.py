@@ -0,0 +1,8 @@
+from if_parser_if import IfParserIf
+from robot.version import get_version
+
+
+class IfParser(IfParserIf):
+
+    ROBOT_LIBRARY_SCOPE = 'TEST SUITE'
+    ROBOT_LIBRARY_VERSION = get_version()
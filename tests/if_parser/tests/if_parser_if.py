@@ -0,0 +1,140 @@
+# Copyright (C) 2019 HAW Hamburg
+#
+# This file is subject to the terms and conditions of the GNU Lesser
+# General Public License v2.1. See the file LICENSE in the top level
+# directory for more details.
+"""@package PyToAPI
+This module handles parsing of information from RIOT if_parser test.
+"""
+import time
+
+from HilShell import HilShell, RE_PLAIN_DICT, bytes_from_data, dict_from_data
+
+FLOOD_CMD = 'test_data_flood()'
+
+
+class IfParserIf(HilShell):
+    """Interface to the a node with if_parser firmware."""
+
+    NAMESPACE = 'parser'
+
+    FW_ID = 'if_parser'
+
+    def app_metadata(self):
+        """Get the metadata of the firmware."""
+        return self.send_cmd('app_metadata')
+
+    def get_metadata(self):
+        """Get the metadata of the firmware."""
+        res = self.app_metadata()
+        res['msg'] = dict_from_data(res.get('data', [])).get('app_name')
+        return res
+
+    def _send_flood_lines(self, send_cmd, timeout):
+        """Send a flood command and convert the plain output to a response."""
+        lines = self.send_cmd_lines(send_cmd, timeout=timeout)
+        res = {'cmd': FLOOD_CMD, 'data': [], 'result': lines[-1]}
+        if FLOOD_CMD not in lines:
+            return res
+        for line in lines[lines.index(FLOOD_CMD) + 1:-1]:
+            match = RE_PLAIN_DICT.match(line)
+            if match:
+                res['data'].append({match.group(1): int(match.group(2))})
+            else:
+                res['data'].append(line)
+        return res
+
+    @staticmethod
+    def _check_flood(items, size):
+        """Count the items that are malformed or missing between items.
+
+        Item i of the firmware holds the bytes i, i + 1, ... modulo 256.
+        """
+        good = malformed = missing = 0
+        expect = 0
+        for item in items:
+            try:
+                data = bytes_from_data(item)
+            except (TypeError, ValueError):
+                data = []
+            if (len(data) != size or
+                    any(b != (data[0] + j) & 0xFF for j, b in
+                        enumerate(data))):
+                malformed += 1
+                expect += 1
+                continue
+            # items lost in between show up as a gap in the first byte
+            gap = (data[0] - expect) & 0xFF
+            missing += gap
+            expect += gap + 1
+            good += 1
+        return good, malformed, missing
+
+    def test_data_flood(self, num, size, timeout=None):
+        """Let the node print num items of size bytes as fast as it can
+
+        The results are added to the response as 'stats' dict with the
+        time on the node, the parsed bytes/s on the host and the number of
+        missing and malformed items. 'bad_frames' counts the frames that
+        the binary parser dropped because of a CRC error.
+        """
+        num = int(num)
+        size = int(size)
+        send_cmd = 'test_data_flood {} {}'.format(num, size)
+        crc_errors = self._bin_decoder.crc_errors if self._bin_decoder else 0
+        start = time.time()
+        if self.parser == 'plain':
+            res = self._send_flood_lines(send_cmd, timeout)
+        else:
+            res = self.send_cmd(send_cmd, timeout)
+        host_s = time.time() - start
+
+        data = res.get('data') or []
+        info = dict_from_data(data)
+        items = [item for item in data if not isinstance(item, dict)]
+        good, malformed, missing = self._check_flood(items, size)
+        # items lost at the end cannot be told from a gap
+        missing += max(0, num - good - malformed - missing)
+        flood_us = info.get('flood_us', 0)
+        res['stats'] = {
+            'items': good,
+            'missing': missing,
+            'malformed': malformed,
+            'bad_frames': (self._bin_decoder.crc_errors - crc_errors
+                           if self._bin_decoder else 0),
+            'flood_us': flood_us,
+            'host_s': host_s,
+            'bytes_per_s': int(good * size / host_s) if host_s else 0,
+            'node_bytes_per_s': (int(num * size * 1000000 / flood_us)
+                                 if flood_us else 0)}
+        return res
+
+    def test_data_int(self, *vals):
+        """Echo integers without printing a command name."""
+        return self.send_cmd(' '.join(['test_data_int'] +
+                                      [str(val) for val in vals]))
+
+    def test_args(self, *args):
+        """Parse the arguments with the spec parser of the node.
+
+        The data of a successful response are the parsed values.
+        """
+        send_cmd = ' '.join(['test_args'] + [str(arg) for arg in args])
+        if self.parser != 'plain':
+            return self.send_cmd(send_cmd)
+        lines = self.send_cmd_lines(send_cmd)
+        # the plain output starts with the command name, the echo is dropped
+        if 'test_args()' in lines:
+            lines = lines[lines.index('test_args()') + 1:]
+        return {'cmd': 'test_args()', 'data': lines[:-1], 'result': lines[-1]}
+
+    def get_command_list(self):
+        """List of all commands."""
+        cmds = list()
+        cmds.append(self.app_metadata)
+        cmds.append(self.get_metadata)
+        cmds.append(self.test_data_flood)
+        cmds.append(self.test_args)
+        cmds.append(self.test_data_int)
+        cmds.append(self.mem_stats)
+        return cmds
@@ -18,38 +18,695 @@
  * @}
  */
 
+#include <inttypes.h>
+#include <stdbool.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 
+#include "cpu.h"
+#include "irq.h"
 #include "shell.h"
+#include "mutex.h"
 #include "periph/gpio.h"
+#include "periph/timer.h"
+#include "xtimer.h"
 
+#include "sc_args.h"
+#include "test_helpers.h"
+#include "test_stats.h"
+#include "test_timer.h"
+
+#ifdef HIL_COMBINED
+#include "hil_combined.h"
+#endif
+
+/* number of pins whose mode is remembered to skip repeated gpio_init */
+#ifndef GPIO_CACHE_SIZE
+#define GPIO_CACHE_SIZE     (8U)
+#endif
+
+/* Cortex-M3 and up count CPU cycles in the DWT, used by gpio_bench */
+#if defined(DWT) && defined(DWT_CTRL_CYCCNTENA_Msk)
+#define BENCH_CYCLE_COUNTER
+#endif
+
+#ifndef SHELL_BUFSIZE
+#define SHELL_BUFSIZE       SHELL_DEFAULT_BUFSIZE
+#endif
+
+#ifdef MODULE_PERIPH_TIMER
+/* number of pins that can be driven by gpio_pattern, one bit of the mask each */
+#define GPIO_PATTERN_PINS   (8U)
+
+/* maximum number of steps of a pattern */
+#ifndef GPIO_PATTERN_MAX
+#define GPIO_PATTERN_MAX    (64U)
+#endif
+
+/* bytes of each encoded step: mask, level and big endian delay in ticks */
+#define GPIO_PATTERN_STEP_LEN   (4U)
+
+/* channel of the pattern timer */
+#define GPIO_PATTERN_CHAN   (0)
+#endif
+
+/* log2 buckets of the gpio_int_trigger latency */
+#define GPIO_INT_BUCKETS    (12U)
+
+/* time gpio_int_trigger waits for each callback */
+#ifndef GPIO_INT_TIMEOUT_US
+#define GPIO_INT_TIMEOUT_US (10U * US_PER_MS)
+#endif
+
+typedef struct {
+    gpio_t pin;
+    gpio_mode_t mode;
+} gpio_cache_t;
+
+static gpio_cache_t gpio_cache[GPIO_CACHE_SIZE];
+static unsigned gpio_cache_numof;
+
+static const struct {
+    const char *name;
+    gpio_mode_t mode;
+} gpio_modes[] = {
+    { "in", GPIO_IN },
+    { "in_pd", GPIO_IN_PD },
+    { "in_pu", GPIO_IN_PU },
+    { "out", GPIO_OUT },
+    { "od", GPIO_OD },
+    { "od_pu", GPIO_OD_PU },
+};
+
+#define GPIO_MODES_NUMOF    (sizeof(gpio_modes) / sizeof(gpio_modes[0]))
+
+static const struct {
+    const char *name;
+    gpio_flank_t flank;
+} gpio_flanks[] = {
+    { "falling", GPIO_FALLING },
+    { "rising", GPIO_RISING },
+    { "both", GPIO_BOTH },
+};
+
+#define GPIO_FLANKS_NUMOF   (sizeof(gpio_flanks) / sizeof(gpio_flanks[0]))
+
+/* state of the interrupt pin, only one can be configured at a time */
+static struct {
+    gpio_t pin;
+    gpio_t resp;
+    gpio_flank_t flank;
+    volatile uint32_t count;
+    volatile uint32_t repeated;
+    volatile int level;
+    volatile bool pending;
+    uint32_t stimulus;
+    volatile uint32_t latency;
+} gpio_int = { .pin = GPIO_UNDEF, .resp = GPIO_UNDEF };
+
+static int _arg2pin(const char *port_arg, const char *pin_arg, gpio_t *pin)
+{
+    int port = 0;
+    int num = 0;
+
+    if ((sc_arg2int(port_arg, &port) != ARGS_OK) ||
+        (sc_arg2int(pin_arg, &num) != ARGS_OK)) {
+        return ARGS_ERROR;
+    }
+    *pin = GPIO_PIN(port, num);
+    return ARGS_OK;
+}
+
+static int _parse_pin(int argc, char **argv, int args, char *usage,
+                      gpio_t *pin)
+{
+    if (sc_args_check(argc, argv, args, args, usage) != ARGS_OK) {
+        return ARGS_ERROR;
+    }
+    return _arg2pin(argv[1], argv[2], pin);
+}
+
+static gpio_cache_t *_cache_find(gpio_t pin)
+{
+    for (unsigned i = 0; i < gpio_cache_numof; i++) {
+        if (gpio_cache[i].pin == pin) {
+            return &gpio_cache[i];
+        }
+    }
+    return NULL;
+}
+
+static void _cache_store(gpio_t pin, gpio_mode_t mode)
+{
+    gpio_cache_t *entry = _cache_find(pin);
+
+    if (!entry) {
+        /* the oldest entry is replaced when the cache is full */
+        if (gpio_cache_numof < GPIO_CACHE_SIZE) {
+            entry = &gpio_cache[gpio_cache_numof++];
+        }
+        else {
+            memmove(gpio_cache, gpio_cache + 1,
+                    sizeof(gpio_cache) - sizeof(gpio_cache[0]));
+            entry = &gpio_cache[GPIO_CACHE_SIZE - 1];
+        }
+    }
+    entry->pin = pin;
+    entry->mode = mode;
+}
+
+/* gpio_init only if the pin is not known to be in the given mode yet */
+static int _init(gpio_t pin, gpio_mode_t mode, bool force)
+{
+    gpio_cache_t *entry = _cache_find(pin);
+
+    if (!force && entry && (entry->mode == mode)) {
+        return 0;
+    }
+
+    int res = gpio_init(pin, mode);
+    if (res == 0) {
+        _cache_store(pin, mode);
+    }
+    return res;
+}
+
+static int _init_out(gpio_t pin)
+{
+    gpio_cache_t *entry = _cache_find(pin);
+
+    /* open drain pins are outputs as well */
+    if (entry && ((entry->mode == GPIO_OUT) || (entry->mode == GPIO_OD) ||
+                  (entry->mode == GPIO_OD_PU))) {
+        return 0;
+    }
+    if (_init(pin, GPIO_OUT, false) != 0) {
+        puts("Error: gpio_init failed");
+        return 1;
+    }
+    return 0;
+}
+
+static int cmd_gpio_init(int argc, char **argv)
+{
+    gpio_t pin;
+    if (_parse_pin(argc, argv, 3, "PORT PIN in|in_pd|in_pu|out|od|od_pu",
+                   &pin) != ARGS_OK) {
+        return 1;
+    }
+
+    for (unsigned i = 0; i < GPIO_MODES_NUMOF; i++) {
+        if (strcmp(argv[3], gpio_modes[i].name) == 0) {
+            if (_init(pin, gpio_modes[i].mode, true) != 0) {
+                puts("Error: gpio_init failed");
+                return 1;
+            }
+            puts("Success: Pin initialized");
+            return 0;
+        }
+    }
+
+    puts("Error: unknown mode");
+    return 1;
+}
 
 static int set(int argc, char **argv)
 {
-    if (argc < 3) {
-        printf("usage: %s <port> <pin>\n", argv[0]);
+    gpio_t pin;
+    if (_parse_pin(argc, argv, 2, "PORT PIN", &pin) != ARGS_OK) {
+        return 1;
+    }
+    if (_init_out(pin) != 0) {
         return 1;
     }
-    gpio_init(GPIO_PIN(atoi(argv[1]), atoi(argv[2])), GPIO_OUT);
-    gpio_set(GPIO_PIN(atoi(argv[1]), atoi(argv[2])));
+    gpio_set(pin);
     printf("Success: Pin set\n");
     return 0;
 }
 
 static int clear(int argc, char **argv)
 {
-    if (argc < 3) {
-        printf("usage: %s <port> <pin>\n", argv[0]);
+    gpio_t pin;
+    if (_parse_pin(argc, argv, 2, "PORT PIN", &pin) != ARGS_OK) {
         return 1;
     }
-    gpio_init(GPIO_PIN(atoi(argv[1]), atoi(argv[2])), GPIO_OUT);
-    gpio_clear(GPIO_PIN(atoi(argv[1]), atoi(argv[2])));
+    if (_init_out(pin) != 0) {
+        return 1;
+    }
+    gpio_clear(pin);
     printf("Success: Pin cleared\n");
     return 0;
 }
 
-int cmd_get_metadata(int argc, char **argv)
+static int cmd_gpio_toggle(int argc, char **argv)
+{
+    gpio_t pin;
+    if (_parse_pin(argc, argv, 2, "PORT PIN", &pin) != ARGS_OK) {
+        return 1;
+    }
+    if (_init_out(pin) != 0) {
+        return 1;
+    }
+    gpio_toggle(pin);
+    puts("Success: Pin toggled");
+    return 0;
+}
+
+static int cmd_gpio_read(int argc, char **argv)
+{
+    gpio_t pin;
+    if (_parse_pin(argc, argv, 2, "PORT PIN", &pin) != ARGS_OK) {
+        return 1;
+    }
+    /* pins that were never initialized are read as input */
+    if (!_cache_find(pin) && (_init(pin, GPIO_IN, false) != 0)) {
+        puts("Error: gpio_init failed");
+        return 1;
+    }
+    printf("Success: Pin read : [%d]\n", gpio_read(pin) ? 1 : 0);
+    return 0;
+}
+
+/* timestamps of the interrupt measurements, CPU cycles if available */
+static inline uint32_t _now(void)
+{
+#ifdef BENCH_CYCLE_COUNTER
+    return DWT->CYCCNT;
+#else
+    return xtimer_now_usec();
+#endif
+}
+
+static void _int_cb(void *arg)
+{
+    (void)arg;
+
+    /* answer first so the response pin shows the raw latency */
+    if (gpio_int.resp != GPIO_UNDEF) {
+        gpio_toggle(gpio_int.resp);
+    }
+    uint32_t now = _now();
+
+    /* with both flanks the level must alternate, otherwise an edge was
+     * missed or an interrupt duplicated */
+    int level = gpio_read(gpio_int.pin) ? 1 : 0;
+    if ((gpio_int.flank == GPIO_BOTH) && gpio_int.count &&
+        (level == gpio_int.level)) {
+        gpio_int.repeated++;
+    }
+    gpio_int.level = level;
+    gpio_int.count++;
+
+    if (gpio_int.pending) {
+        gpio_int.latency = now - gpio_int.stimulus;
+        gpio_int.pending = false;
+    }
+}
+
+static int cmd_gpio_init_int(int argc, char **argv)
+{
+    if (sc_args_check(argc, argv, 4, 6,
+                      "PORT PIN in|in_pd|in_pu falling|rising|both "
+                      "[RESP_PORT RESP_PIN]") != ARGS_OK) {
+        return 1;
+    }
+
+    gpio_t pin;
+    if (_arg2pin(argv[1], argv[2], &pin) != ARGS_OK) {
+        return 1;
+    }
+
+    gpio_t resp = GPIO_UNDEF;
+    if (argc > 6) {
+        if (_arg2pin(argv[5], argv[6], &resp) != ARGS_OK) {
+            return 1;
+        }
+    }
+    else if (argc > 5) {
+        puts("Error: RESP_PIN missing");
+        return 1;
+    }
+
+    unsigned mode = 0;
+    while ((mode < GPIO_MODES_NUMOF) &&
+           (strcmp(argv[3], gpio_modes[mode].name) != 0)) {
+        mode++;
+    }
+    unsigned flank = 0;
+    while ((flank < GPIO_FLANKS_NUMOF) &&
+           (strcmp(argv[4], gpio_flanks[flank].name) != 0)) {
+        flank++;
+    }
+    if ((mode >= GPIO_MODES_NUMOF) || (gpio_modes[mode].mode == GPIO_OUT) ||
+        (flank >= GPIO_FLANKS_NUMOF)) {
+        puts("Error: unknown mode or flank");
+        return 1;
+    }
+
+    if ((resp != GPIO_UNDEF) && (_init_out(resp) != 0)) {
+        return 1;
+    }
+
+    if (gpio_int.pin != GPIO_UNDEF) {
+        gpio_irq_disable(gpio_int.pin);
+    }
+    gpio_int.pin = pin;
+    gpio_int.resp = resp;
+    gpio_int.flank = gpio_flanks[flank].flank;
+    gpio_int.count = 0;
+    gpio_int.repeated = 0;
+    gpio_int.pending = false;
+
+    if (gpio_init_int(pin, gpio_modes[mode].mode, gpio_int.flank,
+                      _int_cb, NULL) != 0) {
+        gpio_int.pin = GPIO_UNDEF;
+        puts("Error: gpio_init_int failed");
+        return 1;
+    }
+    _cache_store(pin, gpio_modes[mode].mode);
+#ifdef BENCH_CYCLE_COUNTER
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+#endif
+
+    puts("Success: Pin interrupt initialized");
+    return 0;
+}
+
+static int cmd_gpio_int_stats(int argc, char **argv)
+{
+    if (sc_args_check(argc, argv, 0, 1, "[reset]") != ARGS_OK) {
+        return 1;
+    }
+    if (gpio_int.pin == GPIO_UNDEF) {
+        puts("Error: no interrupt pin initialized");
+        return 1;
+    }
+
+    unsigned state = irq_disable();
+    uint32_t count = gpio_int.count;
+    uint32_t repeated = gpio_int.repeated;
+    if ((argc > 1) && (strcmp(argv[1], "reset") == 0)) {
+        gpio_int.count = 0;
+        gpio_int.repeated = 0;
+    }
+    irq_restore(state);
+
+    printf("Success: gpio_int_stats count, repeated : "
+           "[%"PRIu32", %"PRIu32"]\n", count, repeated);
+    return 0;
+}
+
+static int cmd_gpio_int_trigger(int argc, char **argv)
+{
+    gpio_t out;
+    if (_parse_pin(argc, argv, 3, "OUT_PORT OUT_PIN N", &out) != ARGS_OK) {
+        return 1;
+    }
+
+    uint32_t num = 0;
+    if ((sc_arg2u32(argv[3], &num) != ARGS_OK) || (num == 0)) {
+        return 1;
+    }
+    if (gpio_int.pin == GPIO_UNDEF) {
+        puts("Error: no interrupt pin initialized");
+        return 1;
+    }
+    if (_init_out(out) != 0) {
+        return 1;
+    }
+
+    test_stats_t stats;
+    uint32_t hist[GPIO_INT_BUCKETS] = { 0 };
+    uint32_t timeouts = 0;
+    test_stats_init(&stats);
+
+    /* the level before a single flank edge must not trigger */
+    if (gpio_int.flank == GPIO_RISING) {
+        gpio_clear(out);
+    }
+    else if (gpio_int.flank == GPIO_FALLING) {
+        gpio_set(out);
+    }
+    xtimer_usleep(GPIO_INT_TIMEOUT_US);
+
+    for (uint32_t i = 0; i < num; i++) {
+        gpio_int.pending = true;
+        gpio_int.stimulus = _now();
+        gpio_toggle(out);
+
+        uint32_t start = xtimer_now_usec();
+        while (gpio_int.pending &&
+               ((xtimer_now_usec() - start) < GPIO_INT_TIMEOUT_US)) {}
+
+        if (gpio_int.pending) {
+            gpio_int.pending = false;
+            timeouts++;
+        }
+        else {
+            uint32_t latency = gpio_int.latency;
+            unsigned bucket = 0;
+            while ((latency >> bucket) && (bucket < GPIO_INT_BUCKETS - 1)) {
+                bucket++;
+            }
+            hist[bucket]++;
+            test_stats_add(&stats, (int32_t)latency);
+        }
+
+        /* restore the level without an edge of interest */
+        if (gpio_int.flank != GPIO_BOTH) {
+            gpio_toggle(out);
+            xtimer_usleep(GPIO_INT_TIMEOUT_US / 10);
+        }
+    }
+
+    printf("Latency: hist [");
+    for (unsigned i = 0; i < GPIO_INT_BUCKETS; i++) {
+        printf(i ? ", %"PRIu32 : "%"PRIu32, hist[i]);
+    }
+    puts("]");
+    printf("Success: gpio_int_trigger count, timeouts, mean, min, max, stddev : "
+           "[%"PRIu32", %"PRIu32", %"PRIi32", %"PRIi32", %"PRIi32", %"PRIu32"]\n",
+           stats.count, timeouts, test_stats_mean(&stats),
+           stats.count ? stats.min : 0, stats.count ? stats.max : 0,
+           test_stats_stddev(&stats));
+    return 0;
+}
+
+#ifdef MODULE_PERIPH_TIMER
+typedef struct {
+    uint8_t mask;
+    uint8_t level;
+    uint16_t delay;
+} pattern_step_t;
+
+static gpio_t pattern_pins[GPIO_PATTERN_PINS];
+static unsigned pattern_pins_numof;
+
+/* the table is only changed while no pattern is played */
+static struct {
+    mutex_t done;
+    tim_t dev;
+    pattern_step_t steps[GPIO_PATTERN_MAX];
+    unsigned numof;
+    unsigned idx;
+    uint32_t repeat;
+    unsigned int target;
+    uint32_t late;
+    uint32_t max_late;
+} pattern = { .done = MUTEX_INIT };
+
+static void _pattern_apply(const pattern_step_t *step)
+{
+    for (unsigned i = 0; i < pattern_pins_numof; i++) {
+        if (step->mask & (1 << i)) {
+            gpio_write(pattern_pins[i], step->level & (1 << i));
+        }
+    }
+}
+
+static void _pattern_cb(void *arg, int channel)
+{
+    (void)arg;
+
+    /* a step that is due when the previous one is done runs at once */
+    while (1) {
+        _pattern_apply(&pattern.steps[pattern.idx]);
+
+        if (++pattern.idx == pattern.numof) {
+            pattern.idx = 0;
+            if (--pattern.repeat == 0) {
+                mutex_unlock(&pattern.done);
+                return;
+            }
+        }
+
+        unsigned int now = timer_read(pattern.dev);
+        uint32_t late = test_timer_ticks_diff(pattern.dev, pattern.target,
+                                                now);
+        if (late > pattern.max_late) {
+            pattern.max_late = late;
+        }
+
+        uint32_t delay = pattern.steps[pattern.idx].delay;
+        pattern.target += delay;
+        if (late < delay) {
+            timer_set(pattern.dev, channel, delay - late);
+            return;
+        }
+        pattern.late++;
+    }
+}
+
+static int cmd_gpio_pattern_pins(int argc, char **argv)
+{
+    if ((sc_args_check(argc, argv, 2, 2 * GPIO_PATTERN_PINS,
+                       "PORT PIN [PORT PIN]...") != ARGS_OK)) {
+        return 1;
+    }
+    if ((argc % 2) == 0) {
+        puts("Error: PIN missing for the last PORT");
+        return 1;
+    }
+
+    gpio_t pins[GPIO_PATTERN_PINS];
+    unsigned numof = (argc - 1) / 2;
+    for (unsigned i = 0; i < numof; i++) {
+        if (_arg2pin(argv[1 + 2 * i], argv[2 + 2 * i], &pins[i]) != ARGS_OK) {
+            return 1;
+        }
+        if (_init_out(pins[i]) != 0) {
+            return 1;
+        }
+    }
+
+    memcpy(pattern_pins, pins, numof * sizeof(pins[0]));
+    pattern_pins_numof = numof;
+    printf("Success: Pattern pins set : [%u]\n", numof);
+    return 0;
+}
+
+static int cmd_gpio_pattern(int argc, char **argv)
+{
+    if (sc_args_check(argc, argv, 3, 4, "DEV FREQ STEPS [REPEAT]") != ARGS_OK) {
+        return 1;
+    }
+
+    int dev = sc_arg2dev(argv[1], TIMER_NUMOF);
+#ifdef XTIMER_DEV
+    if (dev == (int)XTIMER_DEV) {
+        puts("Error: DEV is used by xtimer");
+        return 1;
+    }
+#endif
+    if (dev < 0) {
+        return 1;
+    }
+
+    uint32_t freq = 0;
+    uint32_t repeat = 1;
+    if ((sc_arg2u32(argv[2], &freq) != ARGS_OK) ||
+        ((argc > 4) && (sc_arg2u32(argv[4], &repeat) != ARGS_OK)) ||
+        (repeat == 0)) {
+        return 1;
+    }
+    if (pattern_pins_numof == 0) {
+        puts("Error: no pattern pins set");
+        return 1;
+    }
+
+    static uint8_t buf[GPIO_PATTERN_MAX * GPIO_PATTERN_STEP_LEN];
+    int len = sc_arg2bytes(argv[3], buf, sizeof(buf));
+    if ((len <= 0) || ((len % GPIO_PATTERN_STEP_LEN) != 0)) {
+        printf("Error: STEPS must be 1..%u times MASK LEVEL DELAY_HI DELAY_LO\n",
+               GPIO_PATTERN_MAX);
+        return 1;
+    }
+
+    pattern.numof = len / GPIO_PATTERN_STEP_LEN;
+    for (unsigned i = 0; i < pattern.numof; i++) {
+        const uint8_t *step = &buf[i * GPIO_PATTERN_STEP_LEN];
+        pattern.steps[i].mask = step[0];
+        pattern.steps[i].level = step[1];
+        pattern.steps[i].delay = (step[2] << 8) | step[3];
+    }
+    pattern.dev = TIMER_DEV(dev);
+    pattern.idx = 0;
+    pattern.repeat = repeat;
+    pattern.late = 0;
+    pattern.max_late = 0;
+
+    if (timer_init(pattern.dev, freq, _pattern_cb, NULL) != 0) {
+        puts("Error: timer_init failed");
+        return 1;
+    }
+
+    /* the delay of the first step counts from now */
+    mutex_lock(&pattern.done);
+    pattern.target = timer_read(pattern.dev) + pattern.steps[0].delay;
+    timer_set(pattern.dev, GPIO_PATTERN_CHAN, pattern.steps[0].delay);
+
+    /* wait for unlock by the last step */
+    mutex_lock(&pattern.done);
+    mutex_unlock(&pattern.done);
+    /* the timer keeps counting, so timer_width can measure it afterwards */
+
+    printf("Success: gpio_pattern steps, late, max_late_ticks : "
+           "[%"PRIu32", %"PRIu32", %"PRIu32"]\n",
+           (uint32_t)pattern.numof * repeat, pattern.late, pattern.max_late);
+    return 0;
+}
+
+static int cmd_timer_width(int argc, char **argv)
+{
+    return test_timer_width(0, argc, argv);
+}
+#endif /* MODULE_PERIPH_TIMER */
+
+static int cmd_gpio_bench(int argc, char **argv)
+{
+    gpio_t pin;
+    if (_parse_pin(argc, argv, 3, "PORT PIN N", &pin) != ARGS_OK) {
+        return 1;
+    }
+
+    uint32_t num = 0;
+    if ((sc_arg2u32(argv[3], &num) != ARGS_OK) || (num == 0)) {
+        return 1;
+    }
+    if (_init_out(pin) != 0) {
+        return 1;
+    }
+
+#ifdef BENCH_CYCLE_COUNTER
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+    uint32_t cycles = DWT->CYCCNT;
+#endif
+    uint32_t start = xtimer_now_usec();
+
+    for (uint32_t i = 0; i < num; i++) {
+        gpio_toggle(pin);
+    }
+
+    uint32_t total_us = xtimer_now_usec() - start;
+#ifdef BENCH_CYCLE_COUNTER
+    cycles = DWT->CYCCNT - cycles;
+#else
+    /* without cycle counter the cycles are derived from the duration */
+    uint32_t cycles = (uint32_t)(((uint64_t)total_us * CLOCK_CORECLOCK) /
+                                 US_PER_SEC);
+#endif
+
+    uint64_t hz = ((uint64_t)num * US_PER_SEC) / (total_us ? total_us : 1);
+    printf("Success: gpio_bench cycles_per_toggle, toggle_hz, total_us : "
+           "[%"PRIu32", %"PRIu32", %"PRIu32"]\n",
+           cycles / num, (uint32_t)hz, total_us);
+    return 0;
+}
+
+static int cmd_get_metadata(int argc, char **argv)
 {
     (void)argv;
     (void)argc;
@@ -59,18 +716,55 @@ int cmd_get_metadata(int argc, char **argv)
     return 0;
 }
 
+static const test_helpers_mem_buf_t mem_bufs[] = {
+    TEST_HELPERS_MEM_BUF(gpio_cache),
+#ifdef MODULE_PERIPH_TIMER
+    TEST_HELPERS_MEM_BUF(pattern_pins),
+#endif
+    { NULL, 0 }
+};
+
+static int cmd_mem_stats(int argc, char **argv)
+{
+    return test_helpers_mem_stats(0, mem_bufs, argc, argv);
+}
+
 static const shell_command_t shell_commands[] = {
+    { "gpio_init", "initialize pin with a mode", cmd_gpio_init },
     { "gpio_set", "set pin to HIGH", set },
     { "gpio_clear", "set pin to LOW", clear },
+    { "gpio_toggle", "toggle pin", cmd_gpio_toggle },
+    { "gpio_read", "read pin level", cmd_gpio_read },
+    { "gpio_bench", "toggle pin N times and measure the rate", cmd_gpio_bench },
+    { "gpio_init_int", "initialize pin interrupt with response pin", cmd_gpio_init_int },
+    { "gpio_int_stats", "count the interrupts of the pin", cmd_gpio_int_stats },
+    { "gpio_int_trigger", "toggle a pin wired to the interrupt pin and measure the latency",
+      cmd_gpio_int_trigger },
+#ifdef MODULE_PERIPH_TIMER
+    { "gpio_pattern_pins", "set the pins of the mask bits of gpio_pattern",
+      cmd_gpio_pattern_pins },
+    { "gpio_pattern", "play a pattern of pin levels timed by a periph timer",
+      cmd_gpio_pattern },
+    { "timer_width", "measure or set the counter width of the pattern timer",
+      cmd_timer_width },
+#endif
     { "get_metadata", "Get the metadata of the test firmware", cmd_get_metadata },
+    { "mem_stats", "Print the stack and static buffer usage", cmd_mem_stats },
+#ifdef TEST_HELPERS_STDIO_BAUD
+    TEST_HELPERS_STDIO_BAUD_CMD,
+#endif
     { NULL, NULL, NULL }
 };
 
+#ifdef HIL_COMBINED
+HIL_COMBINED_APP(gpio, shell_commands, NULL);
+#else
 int main(void)
 {
     /* start the shell */
-    char line_buf[SHELL_DEFAULT_BUFSIZE];
-    shell_run(shell_commands, line_buf, SHELL_DEFAULT_BUFSIZE);
+    static char line_buf[SHELL_BUFSIZE];
+    shell_run(shell_commands, line_buf, SHELL_BUFSIZE);
 
     return 0;
 }
+#endif
@@ -6,12 +6,16 @@
 """@package PyToAPI
 This module handles parsing of information from RIOT periph_gpio test.
 """
-from riot_pal import DutShell
+import re
 
+from HilShell import HilShell
 
-class PeriphGpioIf(DutShell):
+
+class PeriphGpioIf(HilShell):
     """Interface to the a node with periph_i2c firmware."""
 
+    NAMESPACE = 'gpio'
+
     FW_ID = 'periph_gpio'
 
     @staticmethod
@@ -25,6 +29,19 @@ class PeriphGpioIf(DutShell):
             port = ord(port[0]) - ord('A')
         return int(port)
 
+    BENCH_STATS = ['cycles_per_toggle', 'toggle_hz', 'total_us']
+    INT_STATS = ['count', 'repeated']
+    LATENCY_STATS = ['count', 'timeouts', 'mean', 'min', 'max', 'stddev']
+    PATTERN_STATS = ['steps', 'late', 'max_late_ticks']
+
+    def gpio_init(self, port, pin, mode='out'):
+        """Initialize the GPIO port and pin with in, in_pd, in_pu, out, od
+        or od_pu mode."""
+
+        return self.send_cmd('gpio_init {} {} {}'
+                             .format(self._convert_port_to_num(port), pin,
+                                     mode))
+
     def gpio_set(self, port, pin):
         """Set the GPIO port and pin to HIGH."""
 
@@ -37,6 +54,105 @@ class PeriphGpioIf(DutShell):
         return self.send_cmd('gpio_clear {} {}'
                              .format(self._convert_port_to_num(port), pin))
 
+    def gpio_toggle(self, port, pin):
+        """Toggle the GPIO port and pin."""
+
+        return self.send_cmd('gpio_toggle {} {}'
+                             .format(self._convert_port_to_num(port), pin))
+
+    def gpio_read(self, port, pin):
+        """Read the level of the GPIO port and pin."""
+
+        return self.send_cmd('gpio_read {} {}'
+                             .format(self._convert_port_to_num(port), pin))
+
+    def gpio_bench(self, port, pin, num=1000):
+        """Toggle the GPIO port and pin num times as fast as possible.
+
+        The 'stats' dict of the response has the cycles per toggle, the
+        toggle rate in Hz and the total duration in us.
+        """
+        res = self.send_cmd('gpio_bench {} {} {}'
+                            .format(self._convert_port_to_num(port), pin, num))
+        res['stats'] = dict(zip(self.BENCH_STATS, res.get('data') or []))
+        return res
+
+    def gpio_init_int(self, port, pin, mode='in', flank='both',
+                      resp_port=None, resp_pin=None):
+        """Initialize an interrupt on the GPIO port and pin.
+
+        The callback toggles the response pin if one is given.
+        """
+        cmd = 'gpio_init_int {} {} {} {}'.format(
+            self._convert_port_to_num(port), pin, mode, flank)
+        if resp_port is not None:
+            cmd += ' {} {}'.format(self._convert_port_to_num(resp_port),
+                                   resp_pin)
+        return self.send_cmd(cmd)
+
+    def gpio_int_stats(self, reset=False):
+        """Get the interrupt count and the callbacks with repeated level.
+
+        The 'stats' dict of the response has 'count' and 'repeated'.
+        """
+        res = self.send_cmd('gpio_int_stats reset' if reset
+                            else 'gpio_int_stats')
+        res['stats'] = dict(zip(self.INT_STATS, res.get('data') or []))
+        return res
+
+    def gpio_int_trigger(self, port, pin, num=100, timeout=None):
+        """Toggle a pin wired to the interrupt pin and measure the latency.
+
+        The 'stats' dict of the response has count, timeouts, mean, min,
+        max and stddev of the latency in CPU cycles, or us without cycle
+        counter, and 'hist' the log2 histogram.
+        """
+        cmd = 'gpio_int_trigger {} {} {}'.format(
+            self._convert_port_to_num(port), pin, num)
+        lines = self.send_cmd_lines(cmd, timeout=timeout)
+        res = {'cmd': cmd, 'msg': lines[-1], 'stats': {}, 'data': [],
+               'result': lines[-1].split(':', 1)[0]}
+        for line in lines:
+            match = re.match(r'Latency: hist \[(.*)\]', line)
+            if match:
+                res['stats']['hist'] = [int(val) for val in
+                                        match.group(1).split(',')]
+        match = re.search(r'\[(.*)\]', lines[-1])
+        if match:
+            res['data'] = [int(val) for val in match.group(1).split(',')]
+            res['stats'].update(zip(self.LATENCY_STATS, res['data']))
+        return res
+
+    def gpio_pattern_pins(self, *pins):
+        """Set the pins of the mask bits of gpio_pattern.
+
+        Each pin is a (port, pin) tuple, the first one is bit 0.
+        """
+        args = ' '.join('{} {}'.format(self._convert_port_to_num(port), pin)
+                        for port, pin in pins)
+        return self.send_cmd('gpio_pattern_pins {}'.format(args))
+
+    @staticmethod
+    def encode_pattern(steps):
+        """Encode (mask, level, delay) steps for gpio_pattern."""
+        data = bytearray()
+        for mask, level, delay in steps:
+            data += bytes([int(mask), int(level)])
+            data += int(delay).to_bytes(2, 'big')
+        return '0x' + data.hex()
+
+    def gpio_pattern(self, dev, freq, steps, repeat=1, timeout=None):
+        """Play (mask, level, delay) steps with a periph timer at freq.
+
+        Each step sets the pins of mask to the bits of level, delay ticks
+        after the previous one. The 'stats' dict of the response has the
+        number of steps played, the late steps and the maximum lateness.
+        """
+        res = self.send_cmd('gpio_pattern {} {} {} {}'.format(
+            dev, freq, self.encode_pattern(steps), repeat), timeout)
+        res['stats'] = dict(zip(self.PATTERN_STATS, res.get('data') or []))
+        return res
+
     def get_metadata(self):
         """Get the metadata of the firmware."""
         return self.send_cmd('get_metadata')
@@ -46,5 +162,8 @@ class PeriphGpioIf(DutShell):
         cmds = list()
         cmds.append(self.gpio_set)
         cmds.append(self.gpio_clear)
+        cmds.append(self.gpio_toggle)
+        cmds.append(self.gpio_read)
+        cmds.append(self.gpio_int_stats)
         cmds.append(self.get_metadata)
         return cmds
@@ -21,22 +21,63 @@
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
 #include <errno.h>
+#include <inttypes.h>
 
 #include "periph_conf.h"
 #include "periph/i2c.h"
 #include "shell.h"
 
 #include "sc_args.h"
+#include "test_helpers.h"
+#include "test_scratch.h"
+#include "test_stats.h"
+#include "xtimer.h"
+
+#ifdef HIL_COMBINED
+#include "hil_combined.h"
+#endif
 
 #ifndef I2C_ACK
 #define I2C_ACK         (0)
 #endif
 
-#define BUFSIZE         (128U)
+/* i2c_buf is the whole scratch arena, borrowed by each command using it */
+static uint8_t *i2c_buf;
+static int i2c_bufsize;
+
+static void _borrow_buf(void)
+{
+    test_scratch_reset();
+    i2c_bufsize = test_scratch_available();
+    i2c_buf = test_scratch_alloc(i2c_bufsize);
+}
 
-/* i2c_buf is global to reduce stack memory consumtion */
-static uint8_t i2c_buf[BUFSIZE];
+static void _print_bytes(const uint8_t *buf, int len)
+{
+    printf("[");
+    /* format the bytes in chunks instead of one printf call per byte */
+    static const char hex[] = "0123456789abcdef";
+    char chunk[8 * 6];
+    int i = 0;
+    while (i < len) {
+        size_t n = 0;
+        for (; i < len && n + 6 <= sizeof(chunk); i++) {
+            if (i != 0) {
+                chunk[n++] = ',';
+                chunk[n++] = ' ';
+            }
+            chunk[n++] = '0';
+            chunk[n++] = 'x';
+            chunk[n++] = hex[buf[i] >> 4];
+            chunk[n++] = hex[buf[i] & 0x0f];
+        }
+        fwrite(chunk, 1, n, stdout);
+    }
+    printf("]\n");
+}
 
 static inline void _print_i2c_read(i2c_t dev, uint16_t *reg, uint8_t *buf, int len)
 {
@@ -44,47 +85,51 @@ static inline void _print_i2c_read(i2c_t dev, uint16_t *reg, uint8_t *buf, int l
     if (reg != NULL) {
         printf("from reg 0x%02x ", *reg);
     }
-    printf(": [");
-    for (int i = 0; i < len; i++) {
-        if (i != 0) {
-            printf(", ");
+    printf(": ");
+    _print_bytes(buf, len);
+}
+
+static const struct {
+    int res;
+    const char *name;
+} _i2c_errors[] = {
+    { -EOPNOTSUPP, "EOPNOTSUPP" },
+    { -EINVAL, "EINVAL" },
+    { -EAGAIN, "EAGAIN" },
+    { -ENXIO, "ENXIO" },
+    { -EIO, "EIO" },
+    { -ETIMEDOUT, "ETIMEDOUT" },
+};
+
+#define I2C_ERRORS_NUMOF    (sizeof(_i2c_errors) / sizeof(_i2c_errors[0]))
+
+static int _i2c_error_idx(int res)
+{
+    for (unsigned i = 0; i < I2C_ERRORS_NUMOF; i++) {
+        if (_i2c_errors[i].res == res) {
+            return i;
         }
-        printf("0x%02x", buf[i]);
     }
-    printf("]\n");
+    return -1;
+}
+
+static const char *_i2c_error_name(int res)
+{
+    int idx = _i2c_error_idx(res);
+    return (idx < 0) ? "Unknown error" : _i2c_errors[idx].name;
 }
 
 static int _print_i2c_error(int res)
 {
-    if (res == -EOPNOTSUPP) {
-        printf("Error: EOPNOTSUPP [%d]\n", -res);
-        return 1;
-    }
-    else if (res == -EINVAL) {
-        printf("Error: EINVAL [%d]\n", -res);
-        return 1;
-    }
-    else if (res == -EAGAIN) {
-        printf("Error: EAGAIN [%d]\n", -res);
-        return 1;
-    }
-    else if (res == -ENXIO) {
-        printf("Error: ENXIO [%d]\n", -res);
-        return 1;
-    }
-    else if (res == -EIO) {
-        printf("Error: EIO [%d]\n", -res);
-        return 1;
-    }
-    else if (res == -ETIMEDOUT) {
-        printf("Error: ETIMEDOUT [%d]\n", -res);
-        return 1;
-    }
-    else if (res == I2C_ACK) {
+    if (res == I2C_ACK) {
         printf("Success: I2C_ACK [%d]\n", res);
         return 0;
     }
-    printf("Error: Unknown error [%d]\n", res);
+    if (_i2c_error_idx(res) < 0) {
+        printf("Error: Unknown error [%d]\n", res);
+        return 1;
+    }
+    printf("Error: %s [%d]\n", _i2c_error_name(res), -res);
     return 1;
 }
 
@@ -164,6 +209,7 @@ int cmd_i2c_read_reg(int argc, char **argv)
 
 int cmd_i2c_read_regs(int argc, char **argv)
 {
+    _borrow_buf();
     int res = sc_args_check(argc, argv, 5, 5, "DEV ADDR REG LEN FLAG");
     if (res != ARGS_OK) {
         return 1;
@@ -186,7 +232,7 @@ int cmd_i2c_read_regs(int argc, char **argv)
         return 1;
     }
 
-    if (len < 1 || len > (int)BUFSIZE) {
+    if (len < 1 || len > i2c_bufsize) {
         puts("Error: invalid LENGTH parameter given");
         return 1;
     }
@@ -203,6 +249,142 @@ int cmd_i2c_read_regs(int argc, char **argv)
     return _print_i2c_error(res);
 }
 
+int cmd_i2c_read_stream(int argc, char **argv)
+{
+    _borrow_buf();
+    int res = sc_args_check(argc, argv, 6, 6, "DEV ADDR REG LEN CHUNK FLAG");
+    if (res != ARGS_OK) {
+        return 1;
+    }
+
+    int dev = sc_arg2dev(argv[1], I2C_NUMOF);
+    if (dev < 0) {
+        return -ENODEV;
+    }
+
+    uint16_t addr = 0;
+    uint16_t reg = 0;
+    uint32_t len = 0;
+    int chunk = 0;
+    uint8_t flags = 0;
+
+    if (sc_arg2u16(argv[2], &addr) != ARGS_OK
+        || sc_arg2u16(argv[3], &reg) != ARGS_OK
+        || sc_arg2u32(argv[4], &len) != ARGS_OK
+        || sc_arg2int(argv[5], &chunk) != ARGS_OK
+        || sc_arg2u8(argv[6], &flags) != ARGS_OK) {
+        return 1;
+    }
+
+    if (len < 1 || chunk < 1 || chunk > i2c_bufsize) {
+        puts("Error: invalid LENGTH or CHUNK parameter given");
+        return 1;
+    }
+
+    /* the registers of a chunk must not wrap around the register space */
+    uint32_t regs_numof = (flags & I2C_REG16) ? 0x10000UL : 0x100UL;
+    if (reg >= regs_numof || len > regs_numof - reg) {
+        puts("Error: REG and LENGTH exceed the register space");
+        return 1;
+    }
+
+    printf("Command: i2c_read_stream(%i, 0x%02x, 0x%02x, %"PRIu32", %i, 0x%02x)\n",
+           dev, addr, reg, len, chunk, flags);
+
+    /* Each chunk is sent before the next one is read, as stdio blocks
+     * until the chunk is written there is nothing to gain from reading
+     * into a second buffer in between */
+    uint16_t crc = TEST_HELPERS_CRC16_INIT;
+    uint32_t offset = 0;
+    while (offset < len) {
+        int n = (len - offset < (uint32_t)chunk) ? (int)(len - offset) : chunk;
+        uint16_t chunk_reg = (uint16_t)(reg + offset);
+        res = i2c_read_regs(dev, addr, chunk_reg, i2c_buf, n, flags);
+        if (res != I2C_ACK) {
+            printf("Chunk: 0x%04x failed\n", chunk_reg);
+            return _print_i2c_error(res);
+        }
+        crc = test_helpers_crc16(crc, i2c_buf, n);
+        printf("Chunk: 0x%04x ", chunk_reg);
+        _print_bytes(i2c_buf, n);
+        offset += n;
+    }
+
+    printf("Success: i2c_%i read %"PRIu32" byte(s) from reg 0x%02x : [0x%04x]\n",
+           dev, len, reg, crc);
+    return 0;
+}
+
+static void _print_i2c_probe(uint16_t first, uint16_t last, int res)
+{
+    printf("Probe: 0x%02x-0x%02x %s [%d]\n",
+           first, last, _i2c_error_name(res), -res);
+}
+
+int cmd_i2c_scan(int argc, char **argv)
+{
+    _borrow_buf();
+    int res = sc_args_check(argc, argv, 1, 3, "DEV [START END]");
+    if (res != ARGS_OK) {
+        return 1;
+    }
+
+    int dev = sc_arg2dev(argv[1], I2C_NUMOF);
+    if (dev < 0) {
+        return -ENODEV;
+    }
+
+    /* skip the reserved addresses by default */
+    uint16_t start = 0x08;
+    uint16_t end = 0x77;
+
+    if (argc == 3
+        || (argc == 4 && (sc_arg2u16(argv[2], &start) != ARGS_OK
+                          || sc_arg2u16(argv[3], &end) != ARGS_OK))) {
+        printf("Usage: %s DEV [START END]\n", argv[0]);
+        puts(TEST_RESULT_ERROR ": START and END must both be addresses");
+        return 1;
+    }
+    if (start > end || end > 0x7f) {
+        puts("Error: invalid address range given");
+        return 1;
+    }
+
+    printf("Command: i2c_scan(%i, 0x%02x, 0x%02x)\n", dev, start, end);
+    res = i2c_acquire(dev);
+    if (res != I2C_ACK) {
+        return _print_i2c_error(res);
+    }
+
+    /* the responding addresses are collected in i2c_buf, consecutive
+     * addresses failing with the same error are printed as one range */
+    int found = 0;
+    uint16_t first = 0;
+    int last_res = I2C_ACK;
+    for (uint16_t addr = start; addr <= end; addr++) {
+        uint8_t data;
+        res = i2c_read_byte(dev, addr, &data, 0);
+        if (res != last_res) {
+            if (last_res != I2C_ACK) {
+                _print_i2c_probe(first, addr - 1, last_res);
+            }
+            first = addr;
+            last_res = res;
+        }
+        if (res == I2C_ACK && found < i2c_bufsize) {
+            i2c_buf[found++] = (uint8_t)addr;
+        }
+    }
+    if (last_res != I2C_ACK) {
+        _print_i2c_probe(first, end, last_res);
+    }
+    i2c_release(dev);
+
+    printf("Success: i2c_%i found %i device(s) : ", dev, found);
+    _print_bytes(i2c_buf, found);
+    return 0;
+}
+
 int cmd_i2c_read_byte(int argc, char **argv)
 {
     int res = sc_args_check(argc, argv, 3, 3, "DEV ADDR FLAG");
@@ -236,6 +418,7 @@ int cmd_i2c_read_byte(int argc, char **argv)
 
 int cmd_i2c_read_bytes(int argc, char **argv)
 {
+    _borrow_buf();
     int res = sc_args_check(argc, argv, 4, 4, "DEV ADDR LENGTH FLAG");
     if (res != ARGS_OK) {
         return 1;
@@ -256,7 +439,7 @@ int cmd_i2c_read_bytes(int argc, char **argv)
         return 1;
     }
 
-    if (len < 1 || len > (int)BUFSIZE) {
+    if (len < 1 || len > i2c_bufsize) {
         puts("Error: invalid LENGTH parameter given");
         return 1;
     }
@@ -309,7 +492,8 @@ int cmd_i2c_write_byte(int argc, char **argv)
 
 int cmd_i2c_write_bytes(int argc, char **argv)
 {
-    int res = sc_args_check(argc, argv, 4, 3 + BUFSIZE,
+    _borrow_buf();
+    int res = sc_args_check(argc, argv, 4, 3 + i2c_bufsize,
                             "DEV ADDR FLAG BYTE0 [BYTE1 [BYTE_n [...]]]");
     if (res != ARGS_OK) {
         return 1;
@@ -389,7 +573,8 @@ int cmd_i2c_write_reg(int argc, char **argv)
 
 int cmd_i2c_write_regs(int argc, char **argv)
 {
-    int res = sc_args_check(argc, argv, 5, 4 + BUFSIZE, "DEV ADDR REG FLAG BYTE0 [BYTE1 ...]");
+    _borrow_buf();
+    int res = sc_args_check(argc, argv, 5, 4 + i2c_bufsize, "DEV ADDR REG FLAG BYTE0 [BYTE1 ...]");
     if (res != ARGS_OK) {
         return 1;
     }
@@ -434,6 +619,97 @@ int cmd_i2c_write_regs(int argc, char **argv)
     return _print_i2c_error(res);
 }
 
+int cmd_i2c_bench(int argc, char **argv)
+{
+    _borrow_buf();
+    int res = sc_args_check(argc, argv, 5, 6, "DEV ADDR REG LEN ITER [READ|WRITE]");
+    if (res != ARGS_OK) {
+        return 1;
+    }
+
+    int dev = sc_arg2dev(argv[1], I2C_NUMOF);
+    if (dev < 0) {
+        return -ENODEV;
+    }
+
+    uint16_t addr = 0;
+    uint16_t reg = 0;
+    int len = 0;
+    uint32_t iter = 0;
+    bool write = false;
+
+    if (sc_arg2u16(argv[2], &addr) != ARGS_OK
+        || sc_arg2u16(argv[3], &reg) != ARGS_OK
+        || sc_arg2int(argv[4], &len) != ARGS_OK
+        || sc_arg2u32(argv[5], &iter) != ARGS_OK) {
+        return 1;
+    }
+    if (argc == 7) {
+        if (strcmp(argv[6], "WRITE") == 0) {
+            write = true;
+        }
+        else if (strcmp(argv[6], "READ") != 0) {
+            puts("Error: invalid transaction, use READ or WRITE");
+            return 1;
+        }
+    }
+    if (len < 1 || len > i2c_bufsize || iter < 1) {
+        puts("Error: invalid LENGTH or ITER parameter given");
+        return 1;
+    }
+
+    printf("Command: i2c_bench(%i, 0x%02x, 0x%02x, %i, %"PRIu32", %s)\n",
+           dev, addr, reg, len, iter, write ? "WRITE" : "READ");
+    res = i2c_acquire(dev);
+    if (res != I2C_ACK) {
+        return _print_i2c_error(res);
+    }
+
+    for (int i = 0; i < len; i++) {
+        i2c_buf[i] = (uint8_t)i;
+    }
+
+    /* the last entry counts unknown errors */
+    uint32_t errors[I2C_ERRORS_NUMOF + 1] = { 0 };
+    test_stats_t stats;
+    test_stats_init(&stats);
+    for (uint32_t i = 0; i < iter; i++) {
+        uint32_t t = xtimer_now_usec();
+        if (write) {
+            res = i2c_write_regs(dev, addr, reg, i2c_buf, len, 0);
+        }
+        else {
+            res = i2c_read_regs(dev, addr, reg, i2c_buf, len, 0);
+        }
+        t = xtimer_now_usec() - t;
+        if (res == I2C_ACK) {
+            test_stats_add(&stats, (int32_t)t);
+        }
+        else {
+            int idx = _i2c_error_idx(res);
+            errors[(idx < 0) ? I2C_ERRORS_NUMOF : (unsigned)idx]++;
+        }
+    }
+    i2c_release(dev);
+
+    for (unsigned i = 0; i <= I2C_ERRORS_NUMOF; i++) {
+        if (errors[i]) {
+            printf("Bench: %s [%"PRIu32"]\n",
+                   (i < I2C_ERRORS_NUMOF) ? _i2c_errors[i].name : "Unknown error",
+                   errors[i]);
+        }
+    }
+
+    uint64_t bytes = (uint64_t)len * stats.count;
+    uint64_t us = (stats.sum > 0) ? (uint64_t)stats.sum : 1;
+    printf("Success: i2c_%i count, mean_us, min_us, max_us, stddev_us, bytes_per_s : "
+           "[%"PRIu32", %"PRIi32", %"PRIi32", %"PRIi32", %"PRIu32", %"PRIu32"]\n",
+           dev, stats.count, test_stats_mean(&stats),
+           stats.count ? stats.min : 0, stats.count ? stats.max : 0,
+           test_stats_stddev(&stats), (uint32_t)((bytes * US_PER_SEC) / us));
+    return 0;
+}
+
 int cmd_i2c_get_devs(int argc, char **argv)
 {
     (void)argv;
@@ -444,7 +720,7 @@ int cmd_i2c_get_devs(int argc, char **argv)
     return 0;
 }
 
-int cmd_get_metadata(int argc, char **argv)
+static int cmd_get_metadata(int argc, char **argv)
 {
     (void)argv;
     (void)argc;
@@ -454,22 +730,37 @@ int cmd_get_metadata(int argc, char **argv)
     return 0;
 }
 
+static int cmd_mem_stats(int argc, char **argv)
+{
+    return test_helpers_mem_stats(0, NULL, argc, argv);
+}
+
 static const shell_command_t shell_commands[] = {
     { "i2c_acquire", "Get access to the I2C bus", cmd_i2c_acquire },
     { "i2c_release", "Release to the I2C bus", cmd_i2c_release },
     { "i2c_read_reg", "Read byte from register", cmd_i2c_read_reg },
     { "i2c_read_regs", "Read bytes from registers", cmd_i2c_read_regs },
+    { "i2c_read_stream", "Read bytes from registers in chunks", cmd_i2c_read_stream },
     { "i2c_read_byte", "Read byte from the I2C device", cmd_i2c_read_byte },
     { "i2c_read_bytes", "Read bytes from the I2C device", cmd_i2c_read_bytes },
     { "i2c_write_byte", "Write byte to the I2C device", cmd_i2c_write_byte },
     { "i2c_write_bytes", "Write bytes to the I2C device", cmd_i2c_write_bytes },
     { "i2c_write_reg", "Write byte to register", cmd_i2c_write_reg },
     { "i2c_write_regs", "Write bytes to registers", cmd_i2c_write_regs },
+    { "i2c_scan", "Get the addresses of the devices on the bus", cmd_i2c_scan },
+    { "i2c_bench", "Measure the duration of register transactions", cmd_i2c_bench },
     { "i2c_get_devs", "Gets amount of supported i2c devices", cmd_i2c_get_devs },
     { "get_metadata", "Get the metadata of the test firmware", cmd_get_metadata },
+    { "mem_stats", "Print the stack and static buffer usage", cmd_mem_stats },
+#ifdef TEST_HELPERS_STDIO_BAUD
+    TEST_HELPERS_STDIO_BAUD_CMD,
+#endif
     { NULL, NULL, NULL }
 };
 
+#ifdef HIL_COMBINED
+HIL_COMBINED_APP(i2c, shell_commands, NULL);
+#else
 int main(void)
 {
     puts("Start: Test for the low-level I2C driver");
@@ -479,3 +770,4 @@ int main(void)
 
     return 0;
 }
+#endif
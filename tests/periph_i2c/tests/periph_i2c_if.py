@@ -7,13 +7,16 @@
 This module handles parsing of information from RIOT periph_i2c test.
 """
 import logging
+import re
 
-from riot_pal import DutShell
+from HilShell import HilShell, crc16_ccitt
 
 
-class PeriphI2cIf(DutShell):
+class PeriphI2cIf(HilShell):
     """Interface to the a node with periph_i2c firmware."""
 
+    NAMESPACE = 'i2c'
+
     FW_ID = 'periph_i2c'
     DEFAULT_DEV = 0
     DEFAULT_ADDR = 85
@@ -42,6 +45,78 @@ class PeriphI2cIf(DutShell):
                              ' {} {} {} {} {}'.format(dev, addr, reg,
                                                       leng, flag))
 
+    def i2c_read_stream(self, dev=DEFAULT_DEV, addr=DEFAULT_ADDR,
+                        reg=DEFAULT_REG, leng=DEFAULT_LEN, chunk=DEFAULT_LEN,
+                        flag=0):
+        """Read bytes from registers in chunks streamed by the node."""
+        cmd = 'i2c_read_stream {} {} {} {} {} {}'.format(dev, addr, reg, leng,
+                                                         chunk, flag)
+        lines = self.send_cmd_lines(cmd)
+        res = {'cmd': cmd, 'data': [], 'msg': lines[-1]}
+        for line in lines:
+            if line.startswith('Chunk:') and '[' in line:
+                res['data'].extend(self._parse_byte_list(line))
+        res['result'] = lines[-1].split(':', 1)[0]
+        if res['result'] == 'Success':
+            crc = self._parse_byte_list(lines[-1])
+            if crc != [crc16_ccitt(res['data'])]:
+                res['result'] = 'Error'
+                res['msg'] = 'Checksum mismatch: {}'.format(lines[-1])
+        return res
+
+    def i2c_scan(self, dev=DEFAULT_DEV, start=None, end=None):
+        """Get the addresses of the devices on the bus.
+
+        The data of the response are the responding addresses, the
+        'errors' dict has the error name of each non-responding address.
+        """
+        cmd = 'i2c_scan {}'.format(dev)
+        if start is not None and end is not None:
+            cmd += ' {} {}'.format(start, end)
+        lines = self.send_cmd_lines(cmd)
+        res = {'cmd': cmd, 'msg': lines[-1], 'errors': {}}
+        for line in lines:
+            match = re.match(r'Probe: (0x[0-9a-f]+)-(0x[0-9a-f]+) (.+) \[', line)
+            if match:
+                for addr in range(int(match.group(1), 0),
+                                  int(match.group(2), 0) + 1):
+                    res['errors'][addr] = match.group(3)
+        res['result'] = lines[-1].split(':', 1)[0]
+        res['data'] = self._parse_byte_list(lines[-1])
+        return res
+
+    BENCH_STATS = ['count', 'mean_us', 'min_us', 'max_us', 'stddev_us',
+                   'bytes_per_s']
+
+    def i2c_bench(self, dev=DEFAULT_DEV, addr=DEFAULT_ADDR, reg=DEFAULT_REG,
+                  leng=DEFAULT_LEN, iterations=100, trans='READ',
+                  timeout=None):
+        """Measure the duration of register transactions on the node.
+
+        The 'stats' dict of the response has the timing of the successful
+        transactions, the 'errors' dict the count of each failure.
+        """
+        cmd = 'i2c_bench {} {} {} {} {} {}'.format(dev, addr, reg, leng,
+                                                   iterations, trans)
+        lines = self.send_cmd_lines(cmd, timeout=timeout)
+        res = {'cmd': cmd, 'msg': lines[-1], 'errors': {}}
+        for line in lines:
+            match = re.match(r'Bench: (.+) \[(\d+)\]', line)
+            if match:
+                res['errors'][match.group(1)] = int(match.group(2))
+        res['result'] = lines[-1].split(':', 1)[0]
+        res['data'] = self._parse_byte_list(lines[-1])
+        res['stats'] = dict(zip(self.BENCH_STATS, res['data']))
+        return res
+
+    @staticmethod
+    def _parse_byte_list(line):
+        """Get the values of the list at the end of a line."""
+        match = re.search(r'\[(.*)\]', line)
+        if match is None or not match.group(1).strip():
+            return []
+        return [int(val, 0) for val in match.group(1).split(',')]
+
     def i2c_read_byte(self, dev=DEFAULT_DEV, addr=DEFAULT_ADDR, flag=0):
         """Read byte from the I2C device."""
         return self.send_cmd('i2c_read_byte {} {} {}'.format(dev, addr, flag))
@@ -96,9 +171,11 @@ class PeriphI2cIf(DutShell):
         cmds = list()
         cmds.append(self.get_metadata)
         cmds.append(self.i2c_get_devs)
+        cmds.append(self.i2c_scan)
         cmds.append(self.i2c_acquire)
         cmds.append(self.i2c_read_reg)
         cmds.append(self.i2c_read_regs)
+        cmds.append(self.i2c_read_stream)
         cmds.append(self.i2c_read_byte)
         cmds.append(self.i2c_read_bytes)
         cmds.append(self.i2c_write_reg)
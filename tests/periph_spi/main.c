@@ -30,7 +30,14 @@
 #include "periph/spi.h"
 #include "shell.h"
 #include "test_helpers.h"
+#include "test_scratch.h"
+#include "test_stats.h"
 #include "sc_args.h"
+#include "xtimer.h"
+
+#ifdef HIL_COMBINED
+#include "hil_combined.h"
+#endif
 
 #ifndef PARSER_DEV_NUM
 #define PARSER_DEV_NUM 0
@@ -45,7 +52,7 @@
 #else
 #define CHECK_ASSERT(x, usage)     do { \
                                 if (!(x)) { \
-                                    puts(usage); \
+                                    print_data_str(PARSER_DEV_NUM, (char *)usage); \
                                     print_result(PARSER_DEV_NUM, TEST_RESULT_ERROR); \
                                     return -1; \
                                 } \
@@ -59,9 +66,68 @@ static struct {
     spi_cs_t cs;
 } spiconf;
 
-char printbuf[64] = {0};
-uint8_t in_buf[64];
-uint8_t out_buf[64];
+#ifndef SHELL_BUFSIZE
+#define SHELL_BUFSIZE   SHELL_DEFAULT_BUFSIZE
+#endif
+
+/* maximum number of OUT bytes shown in the command string */
+#define PRINT_OUT_MAX   (8U)
+
+static char printbuf[160];
+
+/* transfer buffers, each command borrows half of the scratch arena for each */
+static uint8_t *in_buf;
+static uint8_t *out_buf;
+static size_t buf_size;
+
+static void _borrow_bufs(void)
+{
+    test_scratch_reset();
+    buf_size = (test_scratch_available() / 2) & ~(TEST_SCRATCH_ALIGN - 1);
+    out_buf = test_scratch_alloc(buf_size);
+    in_buf = test_scratch_alloc(buf_size);
+}
+
+static int _parse_out_bytes(int argc, char **argv, uint8_t *out)
+{
+    size_t len = 0;
+
+    for (int i = 0; i < argc; i++) {
+        if (argv[i][0] == '*') {
+            /* repeat all bytes given so far */
+            unsigned int repeat;
+            if (len == 0 ||
+                sc_arg2uint(&argv[i][1], &repeat) != ARGS_OK ||
+                repeat == 0 || repeat > buf_size / len) {
+                return ARGS_ERROR;
+            }
+            for (unsigned int r = 1; r < repeat; r++) {
+                memcpy(&out[len * r], out, len);
+            }
+            len *= repeat;
+        }
+        else {
+            int res = sc_arg2bytes(argv[i], &out[len], buf_size - len);
+            if (res == ARGS_ERROR) {
+                return ARGS_ERROR;
+            }
+            len += res;
+        }
+    }
+    return len;
+}
+
+static int _sprint_out_bytes(char *buf, const uint8_t *out, unsigned int len)
+{
+    int offset = 0;
+    for (unsigned int i = 0; i < len && i < PRINT_OUT_MAX; i++) {
+        offset += sprintf(buf + offset, "%u ", out[i]);
+    }
+    if (len > PRINT_OUT_MAX) {
+        offset += sprintf(buf + offset, "... ");
+    }
+    return offset;
+}
 
 int cmd_spi_init(int argc, char **argv)
 {
@@ -95,12 +161,11 @@ int cmd_spi_init_pins(int argc, char **argv)
 int cmd_spi_init_cs(int argc, char **argv)
 {
     const char* USAGE = "spi_init_cs DEV CS_PORT CS_PIN";
-    CHECK_ASSERT(argc == 4, USAGE);
-    int dev = sc_arg2dev(argv[1], SPI_NUMOF);
-    int32_t port, pin = 0;
-    CHECK_ASSERT(dev != ARGS_ERROR &&
-        (sc_arg2s32(argv[2], &port) == ARGS_OK) &&
-        (sc_arg2s32(argv[3], &pin) == ARGS_OK), USAGE);
+    int dev;
+    int32_t port, pin;
+    CHECK_ASSERT(sc_args_parse(argc, argv, "dev s32 s32",
+                               SPI_NUMOF, &dev, &port, &pin) != ARGS_ERROR,
+                 USAGE);
 
     sprintf(printbuf, "spi_init_cs(dev=%i, port=%"PRIi32", pin=%"PRIi32")",
             dev, port, pin);
@@ -120,67 +185,88 @@ int cmd_spi_init_with_gpio_mode(int argc, char **argv)
     return 0;
 }
 
-int cmd_spi_acquire(int argc, char **argv)
+static int _int2mode(int val, spi_mode_t *mode)
 {
-    const char* USAGE = "spi_acquire DEV MODE 100k|400k|1M|5M|10M CS_PORT CS_PIN";
-    CHECK_ASSERT(argc == 6, USAGE);
-    int dev = sc_arg2dev(argv[1], SPI_NUMOF);
-    int mode = 0;
-    int32_t port, pin = 0;
-    CHECK_ASSERT(dev != ARGS_ERROR &&
-        (sc_arg2int(argv[2], &mode) == ARGS_OK) &&
-        (sc_arg2s32(argv[4], &port) == ARGS_OK) &&
-        (sc_arg2s32(argv[5], &pin) == ARGS_OK), USAGE);
-
-    spiconf.dev = SPI_DEV(dev);
-
-    /* parse the SPI mode */
-    mode = atoi(argv[2]);
-    switch (mode) {
+    switch (val) {
         case 0:
-            spiconf.mode = SPI_MODE_0;
+            *mode = SPI_MODE_0;
             break;
         case 1:
-            spiconf.mode = SPI_MODE_1;
+            *mode = SPI_MODE_1;
             break;
         case 2:
-            spiconf.mode = SPI_MODE_2;
+            *mode = SPI_MODE_2;
             break;
         case 3:
-            spiconf.mode = SPI_MODE_3;
+            *mode = SPI_MODE_3;
             break;
         default:
-            CHECK_ASSERT(0, USAGE);
+            return ARGS_ERROR;
     }
+    return ARGS_OK;
+}
 
-    if (strcmp(argv[3], "100k") == 0) {
-        spiconf.clk = SPI_CLK_100KHZ;
-    }
-    else if (strcmp(argv[3], "100k") == 0) {
-        spiconf.clk = SPI_CLK_400KHZ;
-    }
-    else if (strcmp(argv[3], "400k") == 0) {
-        spiconf.clk = SPI_CLK_1MHZ;
-    }
-    else if (strcmp(argv[3], "1M") == 0) {
-        spiconf.clk = SPI_CLK_5MHZ;
-    }
-    else if (strcmp(argv[3], "5M") == 0) {
-        spiconf.clk = SPI_CLK_10MHZ;
+static const struct {
+    const char *name;
+    spi_clk_t clk;
+    uint32_t hz;
+} _clks[] = {
+    { "100k", SPI_CLK_100KHZ, 100000LU },
+    { "400k", SPI_CLK_400KHZ, 400000LU },
+    { "1M", SPI_CLK_1MHZ, 1000000LU },
+    { "5M", SPI_CLK_5MHZ, 5000000LU },
+    { "10M", SPI_CLK_10MHZ, 10000000LU },
+};
+
+#define CLKS_NUMOF      (sizeof(_clks) / sizeof(_clks[0]))
+
+static int _parse_clk(const char *arg, spi_clk_t *clk)
+{
+    for (unsigned int i = 0; i < CLKS_NUMOF; i++) {
+        if (strcmp(arg, _clks[i].name) == 0) {
+            *clk = _clks[i].clk;
+            return ARGS_OK;
+        }
     }
-    else {
-        CHECK_ASSERT(0, USAGE);
+    return ARGS_ERROR;
+}
+
+static uint32_t _clk_hz(spi_clk_t clk)
+{
+    for (unsigned int i = 0; i < CLKS_NUMOF; i++) {
+        if (_clks[i].clk == clk) {
+            return _clks[i].hz;
+        }
     }
+    return 0;
+}
 
+static spi_cs_t _get_cs(int32_t port, int32_t pin)
+{
     if (port == -1) {                    /* hardware chip select line */
-        spiconf.cs = SPI_HWCS(pin);
-    }
-    else {
-        spiconf.cs = (spi_cs_t)GPIO_PIN(port, pin);
+        return SPI_HWCS(pin);
     }
+    return (spi_cs_t)GPIO_PIN(port, pin);
+}
+
+int cmd_spi_acquire(int argc, char **argv)
+{
+    const char* USAGE = "spi_acquire DEV MODE 100k|400k|1M|5M|10M CS_PORT CS_PIN";
+    int dev, mode;
+    const char *clk;
+    int32_t port, pin;
+    CHECK_ASSERT(sc_args_parse(argc, argv, "dev int str s32 s32", SPI_NUMOF,
+                               &dev, &mode, &clk, &port, &pin) != ARGS_ERROR,
+                 USAGE);
+
+    spiconf.dev = SPI_DEV(dev);
+    CHECK_ASSERT(_int2mode(mode, &spiconf.mode) == ARGS_OK, USAGE);
+    CHECK_ASSERT(_parse_clk(clk, &spiconf.clk) == ARGS_OK, USAGE);
+    spiconf.cs = _get_cs(port, pin);
+
     sprintf(printbuf,
             "spi_acquire(bus=%i, port=%"PRIi32", pin=%"PRIi32", mode=%i, clk=%s)",
-            dev, port, pin, mode, argv[3]);
+            dev, port, pin, mode, clk);
     print_cmd(PARSER_DEV_NUM, printbuf);
     CHECK_ASSERT(spi_acquire(spiconf.dev,
                              spiconf.cs,
@@ -233,7 +319,7 @@ int cmd_spi_transfer_byte(int argc, char **argv)
 
 int cmd_spi_transfer_bytes(int argc, char **argv)
 {
-    const char* USAGE = "spi_transfer_bytes DEV CS_PORT CS_PIN CONT IN_LEN [OUT0...OUTn]";
+    const char* USAGE = "spi_transfer_bytes DEV CS_PORT CS_PIN CONT IN_LEN [OUT0...OUTn|0xHEX] [*REPEAT]";
     CHECK_ASSERT(argc >= 6, USAGE);
     int dev = sc_arg2dev(argv[1], SPI_NUMOF);
     int32_t port, pin;
@@ -251,20 +337,21 @@ int cmd_spi_transfer_bytes(int argc, char **argv)
     int offset = sprintf(printbuf,
             "spi_transfer_bytes(dev=%i, port=%"PRIi32", pin=%"PRIi32", cont=%i, out=",
             dev, port, pin, cont);
+    _borrow_bufs();
     if (in_len) {
         in = in_buf;
     }
     if (argc == 6) {
+        CHECK_ASSERT(in_len <= buf_size, "IN_LEN exceeds the scratch buffer");
         offset += sprintf(printbuf + offset, "NULL ");
         len = in_len;
     }
     else {
         out = out_buf;
-        len = argc - 6;
-        for (unsigned int i = 0; i < len; i++) {
-            CHECK_ASSERT(sc_arg2u8(argv[6 + i], &out[i]) == ARGS_OK, "Could not parse OUT bytes");
-            offset += sprintf(printbuf + offset, "%u ", out[i]);
-        }
+        int res = _parse_out_bytes(argc - 6, &argv[6], out);
+        CHECK_ASSERT(res != ARGS_ERROR, "Could not parse OUT bytes");
+        len = res;
+        offset += _sprint_out_bytes(printbuf + offset, out, len);
     }
     sprintf(printbuf + offset, "in=%s len=%u)", in_len ? "data" : "NULL", len);
 
@@ -272,9 +359,7 @@ int cmd_spi_transfer_bytes(int argc, char **argv)
     spi_transfer_bytes(dev, GPIO_PIN(port, pin), cont, out, in, len);
 
     if (in != NULL) {
-        for (unsigned int i = 0; i < len; i++) {
-            print_data_int(PARSER_DEV_NUM, in[i]);
-        }
+        print_data_bytes(PARSER_DEV_NUM, in, len);
     }
 
     print_result(PARSER_DEV_NUM, TEST_RESULT_SUCCESS);
@@ -284,16 +369,12 @@ int cmd_spi_transfer_bytes(int argc, char **argv)
 int cmd_spi_transfer_reg(int argc, char **argv)
 {
     const char* USAGE = "spi_transfer_reg DEV CS_PORT CS_PIN REG OUT";
-    CHECK_ASSERT(argc == 6, USAGE);
-    int dev = sc_arg2dev(argv[1], SPI_NUMOF);
+    int dev;
     int32_t port, pin;
-    unsigned int reg;
-    uint8_t out;
-    CHECK_ASSERT(dev != ARGS_ERROR &&
-        (sc_arg2uint(argv[4], &reg) == ARGS_OK) &&
-        (sc_arg2s32(argv[2], &port) == ARGS_OK) &&
-        (sc_arg2s32(argv[3], &pin) == ARGS_OK) &&
-        (sc_arg2u8(argv[5], &out) == ARGS_OK), USAGE);
+    uint8_t reg, out;
+    CHECK_ASSERT(sc_args_parse(argc, argv, "dev s32 s32 u8 u8", SPI_NUMOF,
+                               &dev, &port, &pin, &reg, &out) != ARGS_ERROR,
+                 USAGE);
 
     sprintf(printbuf,
            "spi_transfer_reg(dev=%i, port=%"PRIi32", pin=%"PRIi32", reg=%u, out=%u)",
@@ -308,7 +389,7 @@ int cmd_spi_transfer_reg(int argc, char **argv)
 
 int cmd_spi_transfer_regs(int argc, char **argv)
 {
-    const char* USAGE = "spi_transfer_regs DEV CS_PORT CS_PIN REG IN_LEN [OUT0...OUTn]";
+    const char* USAGE = "spi_transfer_regs DEV CS_PORT CS_PIN REG IN_LEN [OUT0...OUTn|0xHEX] [*REPEAT]";
     CHECK_ASSERT(argc >= 6, USAGE);
     int dev = sc_arg2dev(argv[1], SPI_NUMOF);
     int32_t port, pin;
@@ -326,20 +407,21 @@ int cmd_spi_transfer_regs(int argc, char **argv)
     int offset = sprintf(printbuf,
             "spi_transfer_regs(dev=%i, port=%"PRIi32", pin=%"PRIi32", reg=%u, out=",
             dev, port, pin, reg);
+    _borrow_bufs();
     if (in_len) {
         in = in_buf;
     }
     if (argc == 6) {
+        CHECK_ASSERT(in_len <= buf_size, "IN_LEN exceeds the scratch buffer");
         offset += sprintf(printbuf + offset, "NULL ");
         len = in_len;
     }
     else {
-        len = 6 - argc;
         out = out_buf;
-        for (unsigned int i = 0; i < len; i++) {
-            CHECK_ASSERT(sc_arg2u8(argv[6 + i], &out[i]) == ARGS_OK, "Could not parse OUT bytes");
-            offset += sprintf(printbuf + offset, "%u ", out[i]);
-        }
+        int res = _parse_out_bytes(argc - 6, &argv[6], out);
+        CHECK_ASSERT(res != ARGS_ERROR, "Could not parse OUT bytes");
+        len = res;
+        offset += _sprint_out_bytes(printbuf + offset, out, len);
     }
     sprintf(printbuf + offset, "in=%s len=%u", in_len ? "data" : "NULL", len);
 
@@ -347,16 +429,132 @@ int cmd_spi_transfer_regs(int argc, char **argv)
     spi_transfer_regs(dev, GPIO_PIN(port, pin), reg, in, out, len);
 
     if (in != NULL) {
-        for (unsigned int i = 0; i < len; i++) {
-            print_data_int(PARSER_DEV_NUM, in_buf[i]);
-        }
+        print_data_bytes(PARSER_DEV_NUM, in, len);
     }
 
     print_result(PARSER_DEV_NUM, TEST_RESULT_SUCCESS);
     return 0;
 }
 
-int cmd_get_metadata(int argc, char **argv)
+int cmd_spi_bench(int argc, char **argv)
+{
+    const char* USAGE = "spi_bench DEV MODE 100k|400k|1M|5M|10M CS_PORT CS_PIN LEN ITER";
+    int dev, mode_arg;
+    const char *clk_arg;
+    int32_t port, pin;
+    unsigned int len, iter;
+    spi_mode_t mode;
+    spi_clk_t clk;
+    CHECK_ASSERT((sc_args_parse(argc, argv, "dev int str s32 s32 uint uint",
+                                SPI_NUMOF, &dev, &mode_arg, &clk_arg, &port,
+                                &pin, &len, &iter) != ARGS_ERROR) &&
+        (_int2mode(mode_arg, &mode) == ARGS_OK) &&
+        (_parse_clk(clk_arg, &clk) == ARGS_OK), USAGE);
+    _borrow_bufs();
+    CHECK_ASSERT(len > 0 && len <= buf_size && iter > 0,
+                 "LEN must fit the scratch buffer and ITER > 0");
+
+    sprintf(printbuf,
+            "spi_bench(dev=%i, port=%"PRIi32", pin=%"PRIi32", mode=%s, clk=%s, len=%u, iter=%u)",
+            dev, port, pin, argv[2], argv[3], len, iter);
+    print_cmd(PARSER_DEV_NUM, printbuf);
+
+    spi_cs_t cs = _get_cs(port, pin);
+    for (unsigned int i = 0; i < len; i++) {
+        out_buf[i] = (uint8_t)i;
+    }
+
+    CHECK_ASSERT(spi_acquire(SPI_DEV(dev), cs, mode, clk) == SPI_OK,
+                 "ERROR initializing SPI");
+
+    test_stats_t stats;
+    test_stats_init(&stats);
+    uint32_t start = xtimer_now_usec();
+    for (unsigned int i = 0; i < iter; i++) {
+        uint32_t t = xtimer_now_usec();
+        spi_transfer_bytes(SPI_DEV(dev), cs, false, out_buf, in_buf, len);
+        test_stats_add(&stats, (int32_t)(xtimer_now_usec() - t));
+    }
+    uint32_t total = xtimer_now_usec() - start;
+    spi_release(SPI_DEV(dev));
+
+    uint64_t bytes = (uint64_t)len * iter;
+    uint64_t transfer_us = (stats.sum > 0) ? (uint64_t)stats.sum : 1;
+    print_data_dict_int(PARSER_DEV_NUM, "total_us", (int32_t)total);
+    print_data_dict_int(PARSER_DEV_NUM, "bytes_per_s",
+                        (int32_t)((bytes * US_PER_SEC) / (total ? total : 1)));
+    print_data_stats(PARSER_DEV_NUM, "xfer_us", &stats);
+    print_data_dict_int(PARSER_DEV_NUM, "clk_hz", (int32_t)_clk_hz(clk));
+    /* clock derived from the time spent in the transfers only */
+    print_data_dict_int(PARSER_DEV_NUM, "eff_clk_hz",
+                        (int32_t)((bytes * 8 * US_PER_SEC) / transfer_us));
+    print_result(PARSER_DEV_NUM, TEST_RESULT_SUCCESS);
+    return 0;
+}
+
+static void _print_clk_dict_int(const char *clk, const char *name, int32_t val)
+{
+    char key[24];
+    sprintf(key, "%s_%s", clk, name);
+    print_data_dict_int(PARSER_DEV_NUM, key, val);
+}
+
+int cmd_spi_clk_sweep(int argc, char **argv)
+{
+    const char* USAGE = "spi_clk_sweep DEV MODE CS_PORT CS_PIN ITER EXPECTED";
+    int dev, mode_arg;
+    int32_t port, pin;
+    unsigned int iter;
+    spi_mode_t mode;
+    _borrow_bufs();
+    /* the expected bytes are kept in out_buf, the transfers send none */
+    size_t len = buf_size;
+    CHECK_ASSERT((sc_args_parse(argc, argv, "dev int s32 s32 uint bytes",
+                                SPI_NUMOF, &dev, &mode_arg, &port, &pin,
+                                &iter, out_buf, &len) != ARGS_ERROR) &&
+        (_int2mode(mode_arg, &mode) == ARGS_OK), USAGE);
+    CHECK_ASSERT(len > 0 && iter > 0, "EXPECTED must not be empty and ITER > 0");
+
+    sprintf(printbuf,
+            "spi_clk_sweep(dev=%i, port=%"PRIi32", pin=%"PRIi32", mode=%s, len=%u, iter=%u)",
+            dev, port, pin, argv[2], (unsigned)len, iter);
+    print_cmd(PARSER_DEV_NUM, printbuf);
+
+    spi_cs_t cs = _get_cs(port, pin);
+
+    for (unsigned int i = 0; i < CLKS_NUMOF; i++) {
+        if (spi_acquire(SPI_DEV(dev), cs, mode, _clks[i].clk) != SPI_OK) {
+            /* the clock is not supported by the board */
+            _print_clk_dict_int(_clks[i].name, "errors", -1);
+            continue;
+        }
+
+        int32_t errors = 0;
+        uint32_t transfer_us = 0;
+        for (unsigned int j = 0; j < iter; j++) {
+            memset(in_buf, 0, len);
+            uint32_t t = xtimer_now_usec();
+            spi_transfer_bytes(SPI_DEV(dev), cs, false, NULL, in_buf, len);
+            transfer_us += xtimer_now_usec() - t;
+            for (unsigned int k = 0; k < len; k++) {
+                errors += (in_buf[k] != out_buf[k]);
+            }
+        }
+        spi_release(SPI_DEV(dev));
+
+        uint64_t bytes = (uint64_t)len * iter;
+        transfer_us = transfer_us ? transfer_us : 1;
+        _print_clk_dict_int(_clks[i].name, "bytes_per_s",
+                            (int32_t)((bytes * US_PER_SEC) / transfer_us));
+        _print_clk_dict_int(_clks[i].name, "eff_clk_hz",
+                            (int32_t)((bytes * 8 * US_PER_SEC) / transfer_us));
+        _print_clk_dict_int(_clks[i].name, "errors", errors);
+    }
+    print_result(PARSER_DEV_NUM, TEST_RESULT_SUCCESS);
+    return 0;
+}
+
+static int cmd_get_metadata(int argc, char **argv)
 {
     (void)argv;
     (void)argc;
@@ -368,9 +566,23 @@ int cmd_get_metadata(int argc, char **argv)
 }
 
 
-#ifdef JSON_SHELL_PARSER
+static const test_helpers_mem_buf_t mem_bufs[] = {
+    TEST_HELPERS_MEM_BUF(printbuf),
+    { NULL, 0 }
+};
+
+static int cmd_mem_stats(int argc, char **argv)
+{
+    return test_helpers_mem_stats(PARSER_DEV_NUM, mem_bufs, argc, argv);
+}
+
+#if defined(JSON_SHELL_PARSER) || defined(BIN_SHELL_PARSER)
 /* Needs a forward declaration since we use shell_commands */
-int cmd_help(int argc, char **argv);
+static int cmd_help(int argc, char **argv);
+static int cmd_batch(int argc, char **argv);
+#ifdef TEST_HELPERS_DURATION
+static int cmd_profile(int argc, char **argv);
+#endif
 #endif
 
 static const shell_command_t shell_commands[] = {
@@ -384,15 +596,25 @@ static const shell_command_t shell_commands[] = {
     { "spi_transfer_bytes", "Transfer a number bytes using the given SPI bus", cmd_spi_transfer_bytes },
     { "spi_transfer_reg", "Transfer one byte to/from a given register address", cmd_spi_transfer_reg },
     { "spi_transfer_regs", "Transfer a number bytes using the given SPI bus", cmd_spi_transfer_regs },
+    { "spi_bench", "Measure the throughput of SPI transfers", cmd_spi_bench },
+    { "spi_clk_sweep", "Measure throughput and data errors for every SPI clock", cmd_spi_clk_sweep },
     { "get_metadata", "Get the metadata of the test firmware", cmd_get_metadata },
-#ifdef JSON_SHELL_PARSER
+    { "mem_stats", "Print the stack and static buffer usage", cmd_mem_stats },
+#ifdef TEST_HELPERS_STDIO_BAUD
+    TEST_HELPERS_STDIO_BAUD_CMD,
+#endif
+#if defined(JSON_SHELL_PARSER) || defined(BIN_SHELL_PARSER)
     { "help", "Override help for parsable help options", cmd_help },
+    { "batch", "Run several commands separated by ; in one call", cmd_batch },
+#ifdef TEST_HELPERS_DURATION
+    { "profile", "Print call count and total duration of each command", cmd_profile },
+#endif
 #endif
     { NULL, NULL, NULL }
 };
 
-#ifdef JSON_SHELL_PARSER
-int cmd_help(int argc, char **argv)
+#if defined(JSON_SHELL_PARSER) || defined(BIN_SHELL_PARSER)
+static int cmd_help(int argc, char **argv)
 {
     (void)argc;
     (void)argv;
@@ -402,14 +624,35 @@ int cmd_help(int argc, char **argv)
     print_result(PARSER_DEV_NUM, TEST_RESULT_SUCCESS);
     return 0;
 }
+
+static int cmd_batch(int argc, char **argv)
+{
+    return test_helpers_batch(PARSER_DEV_NUM, shell_commands, argc, argv);
+}
+
+#ifdef TEST_HELPERS_DURATION
+static int cmd_profile(int argc, char **argv)
+{
+    return test_helpers_profile(PARSER_DEV_NUM, shell_commands, argc, argv);
+}
+#endif
 #endif
 
+#ifdef HIL_COMBINED
+HIL_COMBINED_APP(spi, shell_commands, NULL);
+#else
 int main(void)
 {
     puts("Start: tests/periph_spi");
 
-    char line_buf[SHELL_DEFAULT_BUFSIZE];
-    shell_run(shell_commands, line_buf, SHELL_DEFAULT_BUFSIZE);
+    static char line_buf[SHELL_BUFSIZE];
+#ifdef TEST_HELPERS_DURATION
+    shell_run(test_helpers_profile_commands(shell_commands), line_buf,
+              SHELL_BUFSIZE);
+#else
+    shell_run(shell_commands, line_buf, SHELL_BUFSIZE);
+#endif
 
     return 0;
 }
+#endif
@@ -8,12 +8,14 @@ This module handles parsing of information from RIOT periph_i2c test.
 """
 import logging
 
-from riot_pal import DutShell
+from HilShell import HilShell, bytes_from_data, dict_from_data
 
 
-class PeriphSpiIf(DutShell):
+class PeriphSpiIf(HilShell):
     """Interface to the a node with periph_spi firmware."""
 
+    NAMESPACE = 'spi'
+
     def spi_init(self, dev):
         """Basic initialization of the given SPI bus"""
         return self.send_cmd('spi_init {}'.format(dev))
@@ -42,23 +44,85 @@ class PeriphSpiIf(DutShell):
         """Transfer one byte on the given SPI bus"""
         return self.send_cmd('spi_transfer_byte {} {} {} {}'.format(dev, port, pin, cont, out))
 
-    def spi_transfer_bytes(self, dev, port, pin, cont, in_len, out=None):
+    @staticmethod
+    def _out_arg(out, repeat=None):
+        """Format OUT bytes given as list, bytes or string for the shell"""
+        if isinstance(out, (list, tuple, bytes, bytearray)):
+            out = '0x' + bytes(int(b, 0) if isinstance(b, str) else b
+                               for b in out).hex()
+        if repeat:
+            out = '{} *{}'.format(out, repeat)
+        return out
+
+    def spi_transfer_bytes(self, dev, port, pin, cont, in_len, out=None,
+                           repeat=None):
         """Transfer a number bytes using the given SPI bus"""
         if out:
-            return self.send_cmd('spi_transfer_bytes {} {} {} {} {} {}'.format(dev, port, pin, cont, in_len, out))
+            return self.send_bytes_cmd('spi_transfer_bytes {} {} {} {} {} {}'.format(dev, port, pin, cont, in_len, self._out_arg(out, repeat)))
         else:
-            return self.send_cmd('spi_transfer_bytes {} {} {} {} {}'.format(dev, port, pin, cont, in_len))
+            return self.send_bytes_cmd('spi_transfer_bytes {} {} {} {} {}'.format(dev, port, pin, cont, in_len))
 
     def spi_transfer_reg(self, dev, port, pin, reg, out):
         """Transfer one byte to/from a given register address"""
         return self.send_cmd('spi_transfer_reg {} {} {} {} {}'.format(dev, port, pin, reg, out))
 
-    def spi_transfer_regs(self, dev, port, pin, reg, in_len, out=None):
+    def spi_transfer_regs(self, dev, port, pin, reg, in_len, out=None,
+                          repeat=None):
         """Transfer a number bytes using the given SPI bus"""
         if out:
-            return self.send_cmd('spi_transfer_regs {} {} {} {} {} {}'.format(dev, port, pin, reg, in_len, out))
+            return self.send_bytes_cmd('spi_transfer_regs {} {} {} {} {} {}'.format(dev, port, pin, reg, in_len, self._out_arg(out, repeat)))
         else:
-            return self.send_cmd('spi_transfer_regs {} {} {} {} {}'.format(dev, port, pin, reg, in_len))
+            return self.send_bytes_cmd('spi_transfer_regs {} {} {} {} {}'.format(dev, port, pin, reg, in_len))
+
+    def spi_batch_transfer_bytes(self, dev, port, pin, mode, clk, in_len,
+                                 out=None):
+        """Acquire, transfer a number of bytes and release in one batch
+
+        The data of the response are the bytes of the transfer.
+        """
+        transfer = 'spi_transfer_bytes {} {} {} 0 {}'.format(dev, port, pin,
+                                                             in_len)
+        if out:
+            transfer += ' {}'.format(self._out_arg(out))
+        res = self.batch('spi_acquire {} {} {} {} {}'.format(dev, mode, clk,
+                                                             port, pin),
+                         transfer,
+                         'spi_release {}'.format(dev),
+                         stop_on_error=True)
+        data = res.get('data', [])
+        if len(data) > 1 and isinstance(data[1], dict):
+            xfer = data[1].get('data')
+            res['data'] = bytes_from_data(xfer[0]) if xfer else []
+        return res
+
+    def spi_bench(self, dev, port, pin, mode, clk, length, iterations,
+                  timeout=None):
+        """Measure the throughput of SPI transfers on the node
+
+        The results are added to the response as 'stats' dict.
+        """
+        res = self.send_cmd('spi_bench {} {} {} {} {} {} {}'.format(
+            dev, mode, clk, port, pin, length, iterations), timeout)
+        res['stats'] = dict_from_data(res.get('data', []))
+        return res
+
+    def spi_clk_sweep(self, dev, port, pin, mode, expected, iterations,
+                      timeout=None):
+        """Measure throughput and data errors for every SPI clock
+
+        Each transfer reads as many bytes as ``expected`` has and counts the
+        ones that differ. The results are added to the response as 'clocks'
+        dict with the results of each clock, unsupported clocks have -1
+        errors.
+        """
+        res = self.send_cmd('spi_clk_sweep {} {} {} {} {} {}'.format(
+            dev, mode, port, pin, iterations, self._out_arg(expected)),
+            timeout)
+        res['clocks'] = {}
+        for key, val in dict_from_data(res.get('data', [])).items():
+            clk, name = key.split('_', 1)
+            res['clocks'].setdefault(clk, {})[name] = val
+        return res
 
     def i2c_get_devs(self):
         """Gets amount of supported i2c devices."""
@@ -1 +1,4 @@
 LIST__VAL_1 = [254, 0, 1, 2, 3]
+
+# neither idle level of MISO, each bit toggles along the pattern
+LIST__SWEEP_PATTERN = [0xa5, 0x5a, 0x0f, 0xf0, 0x33, 0xcc, 0x01, 0x80] * 4
@@ -18,18 +18,27 @@
  * @}
  */
 
+#include <inttypes.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <errno.h>
 #include <string.h>
 #include <stdbool.h>
 
+#include "cpu.h"
 #include "shell.h"
 #include "periph/timer.h"
 #include "periph/gpio.h"
 #include "mutex.h"
 
 #include "sc_args.h"
+#include "test_helpers.h"
+#include "test_stats.h"
+#include "test_timer.h"
+
+#ifdef HIL_COMBINED
+#include "hil_combined.h"
+#endif
 
 #define ARG_ERROR       (-1)
 #define CONVERT_ERROR   (-32768)
@@ -42,8 +51,58 @@
 #define CB_HIGH_STR     "cb_high"
 #define CB_LOW_STR      "cb_low"
 
+/* Cortex-M3 and up count CPU cycles in the DWT, used as bench reference */
+#if defined(DWT) && defined(DWT_CTRL_CYCCNTENA_Msk)
+#define BENCH_CYCLE_COUNTER
+#endif
+
+/* timeout used by the bench, it is cleared before it expires */
+#ifndef BENCH_TIMEOUT_TICKS
+#define BENCH_TIMEOUT_TICKS     (0x4000U)
+#endif
+
+#define BENCH_CALIBRATION_RUNS  (16U)
+
+/* maximum number of callbacks recorded by timer_jitter */
+#ifndef JITTER_SAMPLES_MAX
+#define JITTER_SAMPLES_MAX      (256U)
+#endif
+
+/* log2 buckets of the absolute error, the last one holds all larger errors */
+#define JITTER_BUCKETS          (8U)
+
+/* number of channels per device recorded for timer_results */
+#ifndef TIMER_CHAN_SLOTS
+#define TIMER_CHAN_SLOTS        (4U)
+#endif
+
+#define SLOT_IDLE               (0U)
+#define SLOT_ARMED              (1U)
+#define SLOT_FIRED              (2U)
+
 static mutex_t cb_mutex;
 static gpio_t debug_pins[TIMER_NUMOF];
+static uint32_t timer_freq[TIMER_NUMOF];
+/* reference of the bench, a timer device or -1 for the cycle counter */
+static int bench_ref = -1;
+
+/* state of timer_jitter, written by the callback only while it runs */
+static struct {
+    mutex_t done;
+    unsigned int ticks;
+    unsigned count;
+    unsigned num;
+    unsigned int samples[JITTER_SAMPLES_MAX];
+} jitter = { .done = MUTEX_INIT };
+
+/* timestamps of the callbacks, collected with timer_results */
+typedef struct {
+    volatile uint8_t state;
+    unsigned int armed;
+    volatile unsigned int fired;
+} chan_slot_t;
+
+static chan_slot_t slots[TIMER_NUMOF][TIMER_CHAN_SLOTS];
 
 static inline void _debug_toogle(gpio_t pin)
 {
@@ -66,6 +125,20 @@ static inline void _debug_clear(gpio_t pin)
     }
 }
 
+
+/* records a channel armed by timer_set_async, returns false for the others
+ * so only their callback wakes up a blocking timer_set */
+static inline bool _record(int dev, int channel)
+{
+    if (((unsigned)channel < TIMER_CHAN_SLOTS) &&
+        (slots[dev][channel].state == SLOT_ARMED)) {
+        slots[dev][channel].fired = timer_read(dev);
+        slots[dev][channel].state = SLOT_FIRED;
+        return true;
+    }
+    return false;
+}
+
 static int _print_cmd_result(const char *cmd, bool success, int ret,
                              bool print_ret)
 {
@@ -82,26 +155,29 @@ static int _print_cmd_result(const char *cmd, bool success, int ret,
 
 void cb_toggle(void *arg, int channel)
 {
-    (void)channel;
-    gpio_t pin = (gpio_t)(intptr_t)arg;
-    _debug_toogle(pin);
-    mutex_unlock(&cb_mutex);
+    int dev = (int)(intptr_t)arg;
+    _debug_toogle(debug_pins[dev]);
+    if (!_record(dev, channel)) {
+        mutex_unlock(&cb_mutex);
+    }
 }
 
 void cb_high(void *arg, int channel)
 {
-    (void)channel;
-    gpio_t pin = (gpio_t)(intptr_t)arg;
-    _debug_set(pin);
-    mutex_unlock(&cb_mutex);
+    int dev = (int)(intptr_t)arg;
+    _debug_set(debug_pins[dev]);
+    if (!_record(dev, channel)) {
+        mutex_unlock(&cb_mutex);
+    }
 }
 
 void cb_low(void *arg, int channel)
 {
-    (void)channel;
-    gpio_t pin = (gpio_t)(intptr_t)arg;
-    _debug_clear(pin);
-    mutex_unlock(&cb_mutex);
+    int dev = (int)(intptr_t)arg;
+    _debug_clear(debug_pins[dev]);
+    if (!_record(dev, channel)) {
+        mutex_unlock(&cb_mutex);
+    }
 }
 
 /* API calls */
@@ -138,7 +214,10 @@ int cmd_timer_init(int argc, char **argv)
         return ARGS_ERROR;
     }
 
-    int res = timer_init(dev, freq, cb, (void*)(intptr_t)debug_pins[dev]);
+    int res = timer_init(dev, freq, cb, (void*)(intptr_t)dev);
+    if (res == 0) {
+        timer_freq[dev] = freq;
+    }
 
     return _print_cmd_result("timer_init", res == 0, res, true);
 }
@@ -164,6 +243,11 @@ int _timer_set(int argc, char **argv, bool absolute)
         return ARGS_ERROR;
     }
 
+    /* a blocking timer_set takes over a channel of timer_set_async */
+    if ((unsigned)chan < TIMER_CHAN_SLOTS) {
+        slots[dev][chan].state = SLOT_IDLE;
+    }
+
     int res = 0;
     mutex_lock(&cb_mutex);
 
@@ -195,6 +279,87 @@ int cmd_timer_set_absolute(int argc, char **argv)
     return _print_cmd_result("timer_set_absolute", (res == 0), res, true);
 }
 
+int cmd_timer_set_async(int argc, char **argv)
+{
+    if (sc_args_check(argc, argv, 3, 2 * TIMER_CHAN_SLOTS + 1,
+                      "DEV CHANNEL TICKS [CHANNEL TICKS]...") != ARGS_OK) {
+        return ARGS_ERROR;
+    }
+    if ((argc % 2) != 0) {
+        puts("Error: TICKS missing for the last CHANNEL");
+        return ARGS_ERROR;
+    }
+
+    int dev = sc_arg2dev(argv[1], TIMER_NUMOF);
+    if (dev < 0) {
+        return -ENODEV;
+    }
+
+    /* parse all pairs first so the channels are armed back to back */
+    int num = (argc - 2) / 2;
+    int chans[TIMER_CHAN_SLOTS];
+    unsigned int ticks[TIMER_CHAN_SLOTS];
+    for (int i = 0; i < num; i++) {
+        if ((sc_arg2int(argv[2 + 2 * i], &chans[i]) != ARGS_OK) ||
+            (sc_arg2uint(argv[3 + 2 * i], &ticks[i]) != ARGS_OK)) {
+            return ARGS_ERROR;
+        }
+        if ((unsigned)chans[i] >= TIMER_CHAN_SLOTS) {
+            printf("Error: CHANNEL must be below %u\n", TIMER_CHAN_SLOTS);
+            return ARGS_ERROR;
+        }
+    }
+
+    for (int i = 0; i < num; i++) {
+        int chan = chans[i];
+
+        slots[dev][chan].state = SLOT_ARMED;
+        slots[dev][chan].armed = timer_read(dev);
+        int res = timer_set(dev, chan, ticks[i]);
+        if (res != 0) {
+            slots[dev][chan].state = SLOT_IDLE;
+            return _print_cmd_result("timer_set_async", false, res, true);
+        }
+    }
+
+    return _print_cmd_result("timer_set_async", true, num, true);
+}
+
+int cmd_timer_results(int argc, char **argv)
+{
+    if (sc_args_check(argc, argv, 1, 1, "DEV") != ARGS_OK) {
+        return ARGS_ERROR;
+    }
+
+    int dev = sc_arg2dev(argv[1], TIMER_NUMOF);
+    if (dev < 0) {
+        return -ENODEV;
+    }
+
+    unsigned fired = 0;
+    unsigned pending = 0;
+    for (unsigned chan = 0; chan < TIMER_CHAN_SLOTS; chan++) {
+        chan_slot_t *slot = &slots[dev][chan];
+        if (slot->state == SLOT_ARMED) {
+            printf("Result: %u armed : [%u]\n", chan, slot->armed);
+            pending++;
+        }
+        else if (slot->state == SLOT_FIRED) {
+            /* collected results are released for the next run */
+            unsigned int stamp = slot->fired;
+            slot->state = SLOT_IDLE;
+            printf("Result: %u fired : [%u, %u, %"PRIu32"]\n", chan,
+                   slot->armed, stamp,
+                   test_timer_ticks_diff(dev, slot->armed, stamp));
+            fired++;
+        }
+    }
+
+    printf("Success: timer_results(): fired, pending : [%u, %u]\n",
+           fired, pending);
+    return RESULT_OK;
+}
+
 int cmd_timer_clear(int argc, char **argv)
 {
     if (sc_args_check(argc, argv, 2, 2, "DEV CHANNEL") != ARGS_OK) {
@@ -212,6 +377,9 @@ int cmd_timer_clear(int argc, char **argv)
     }
 
     int res = timer_clear(dev, chan);
+    if ((res == 0) && ((unsigned)chan < TIMER_CHAN_SLOTS)) {
+        slots[dev][chan].state = SLOT_IDLE;
+    }
 
     return _print_cmd_result("timer_clear", (res == 0), res, true);
 }
@@ -287,9 +455,90 @@ int cmd_timer_debug_pin(int argc, char **argv)
     return _print_cmd_result("timer_debug_pin", true, 0, false);
 }
 
+static inline uint32_t _bench_now(void)
+{
+#ifdef BENCH_CYCLE_COUNTER
+    if (bench_ref < 0) {
+        return DWT->CYCCNT;
+    }
+#endif
+    return timer_read(bench_ref);
+}
+
+static int _bench_ref_init(int ref)
+{
+    if (ref >= 0) {
+        bench_ref = ref;
+        return 0;
+    }
+#ifdef BENCH_CYCLE_COUNTER
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+    bench_ref = -1;
+    return 0;
+#else
+    puts("Error: no cycle counter, a REF_DEV is needed");
+    return -1;
+#endif
+}
+
+static uint32_t _bench_ref_hz(void)
+{
+    if (bench_ref >= 0) {
+        return timer_freq[bench_ref];
+    }
+#ifdef CLOCK_CORECLOCK
+    return CLOCK_CORECLOCK;
+#else
+    return 0;
+#endif
+}
+
+/* ticks since start, a REF_DEV may wrap below 32 bit */
+static inline uint32_t _bench_diff(uint32_t start)
+{
+    uint32_t now = _bench_now();
+
+    if (bench_ref >= 0) {
+        return test_timer_ticks_diff(bench_ref, start, now);
+    }
+    return now - start;
+}
+
+/* time of reading the reference twice, subtracted from each sample */
+static uint32_t _bench_calibrate(void)
+{
+    uint32_t offset = UINT32_MAX;
+
+    for (unsigned i = 0; i < BENCH_CALIBRATION_RUNS; i++) {
+        uint32_t start = _bench_now();
+        uint32_t diff = _bench_diff(start);
+        if (diff < offset) {
+            offset = diff;
+        }
+    }
+    return offset;
+}
+
+static inline void _bench_add(test_stats_t *stats, uint32_t start,
+                              uint32_t offset)
+{
+    uint32_t diff = _bench_diff(start);
+    test_stats_add(stats, (diff > offset) ? (int32_t)(diff - offset) : 0);
+}
+
+static void _print_bench(const char *name, const test_stats_t *stats)
+{
+    printf("Bench: %s count, mean, min, max : "
+           "[%"PRIu32", %"PRIi32", %"PRIi32", %"PRIi32"]\n",
+           name, stats->count, test_stats_mean(stats),
+           stats->count ? stats->min : 0, stats->count ? stats->max : 0);
+}
+
 int cmd_timer_bench_read(int argc, char **argv)
 {
-    if (sc_args_check(argc, argv, 2, 2, "DEV REPEAT") != ARGS_OK) {
+    if (sc_args_check(argc, argv, 2, 4, "DEV REPEAT [CHANNEL [REF_DEV]]")
+        != ARGS_OK) {
         return ARGS_ERROR;
     }
 
@@ -303,6 +552,31 @@ int cmd_timer_bench_read(int argc, char **argv)
         return ARGS_ERROR;
     }
 
+    int chan = 0;
+    if ((argc > 3) && (sc_arg2int(argv[3], &chan) != ARGS_OK)) {
+        return ARGS_ERROR;
+    }
+
+    int ref = -1;
+    if (argc > 4) {
+        ref = sc_arg2dev(argv[4], TIMER_NUMOF);
+        if ((ref < 0) || (ref == dev)) {
+            return -ENODEV;
+        }
+        /* ref_hz comes from timer_init, the ticks are useless without it */
+        if (timer_freq[ref] == 0) {
+            puts("Error: REF_DEV is not initialized, run timer_init first");
+            return _print_cmd_result("cmd_timer_read_bench", false, 1, false);
+        }
+    }
+
+    if (_bench_ref_init(ref) != 0) {
+        return _print_cmd_result("cmd_timer_read_bench", false, 1, false);
+    }
+    uint32_t offset = _bench_calibrate();
+
+    /* the plain loop is bracketed by the debug pin for external measurement */
+    uint32_t loop_start = _bench_now();
     _debug_toogle(debug_pins[dev]);
 
     for (unsigned int i = 0; i < repeat; i++) {
@@ -310,11 +584,152 @@ int cmd_timer_bench_read(int argc, char **argv)
     }
 
     _debug_toogle(debug_pins[dev]);
+    uint32_t loop = _bench_diff(loop_start);
 
-    return _print_cmd_result("cmd_timer_read_bench", true, 0, false);
+    test_stats_t read, set, set_abs, clear;
+    test_stats_init(&read);
+    test_stats_init(&set);
+    test_stats_init(&set_abs);
+    test_stats_init(&clear);
+
+    for (unsigned int i = 0; i < repeat; i++) {
+        uint32_t start = _bench_now();
+        unsigned int now = timer_read(dev);
+        _bench_add(&read, start, offset);
+
+        /* the timeouts are cleared long before they expire */
+        start = _bench_now();
+        timer_set(dev, chan, BENCH_TIMEOUT_TICKS);
+        _bench_add(&set, start, offset);
+
+        start = _bench_now();
+        timer_clear(dev, chan);
+        _bench_add(&clear, start, offset);
+
+        start = _bench_now();
+        timer_set_absolute(dev, chan, now + BENCH_TIMEOUT_TICKS);
+        _bench_add(&set_abs, start, offset);
+
+        timer_clear(dev, chan);
+    }
+
+    printf("Bench: timer_read loop : [%"PRIu32"]\n", loop);
+    _print_bench("timer_read", &read);
+    _print_bench("timer_set", &set);
+    _print_bench("timer_set_absolute", &set_abs);
+    _print_bench("timer_clear", &clear);
+    printf("Success: cmd_timer_read_bench(): ref_hz : [%"PRIu32"]\n",
+           _bench_ref_hz());
+    return RESULT_OK;
 }
 
-int cmd_get_metadata(int argc, char **argv)
+static void _jitter_cb(void *arg, int channel)
+{
+    tim_t dev = (tim_t)(intptr_t)arg;
+
+    if (jitter.count >= jitter.num) {
+        return;
+    }
+    jitter.samples[jitter.count++] = timer_read(dev);
+    if (jitter.count < jitter.num) {
+        timer_set(dev, channel, jitter.ticks);
+    }
+    else {
+        mutex_unlock(&jitter.done);
+    }
+}
+
+static unsigned _jitter_bucket(int32_t err)
+{
+    uint32_t abs_err = (err < 0) ? -(uint32_t)err : (uint32_t)err;
+    unsigned bucket = 0;
+
+    while (abs_err && (bucket < JITTER_BUCKETS - 1)) {
+        abs_err >>= 1;
+        bucket++;
+    }
+    return bucket;
+}
+
+int cmd_timer_jitter(int argc, char **argv)
+{
+    if (sc_args_check(argc, argv, 5, 5, "DEV CHAN FREQ TICKS N") != ARGS_OK) {
+        return ARGS_ERROR;
+    }
+
+    int dev = sc_arg2dev(argv[1], TIMER_NUMOF);
+    if (dev < 0) {
+        return -ENODEV;
+    }
+
+    int chan = 0;
+    long freq = 0;
+    unsigned int ticks = 0;
+    unsigned int num = 0;
+    if ((sc_arg2int(argv[2], &chan) != ARGS_OK) ||
+        (sc_arg2long(argv[3], &freq) != ARGS_OK) ||
+        (sc_arg2uint(argv[4], &ticks) != ARGS_OK) ||
+        (sc_arg2uint(argv[5], &num) != ARGS_OK)) {
+        return ARGS_ERROR;
+    }
+
+    if ((num == 0) || (num > JITTER_SAMPLES_MAX)) {
+        printf("Error: N must be 1..%u\n", JITTER_SAMPLES_MAX);
+        return ARGS_ERROR;
+    }
+
+    int res = timer_init(dev, freq, _jitter_cb, (void *)(intptr_t)dev);
+    if (res != 0) {
+        return _print_cmd_result("timer_jitter", false, res, true);
+    }
+    timer_freq[dev] = freq;
+
+    jitter.ticks = ticks;
+    jitter.num = num;
+    jitter.count = 0;
+    mutex_lock(&jitter.done);
+
+    unsigned int start = timer_read(dev);
+    res = timer_set(dev, chan, ticks);
+    if (res != 0) {
+        mutex_unlock(&jitter.done);
+        timer_init(dev, freq, cb_toggle, (void *)(intptr_t)dev);
+        return _print_cmd_result("timer_jitter", false, res, true);
+    }
+
+    /* wait for unlock by the last callback */
+    mutex_lock(&jitter.done);
+    mutex_unlock(&jitter.done);
+
+    /* later timer_set calls need the normal callback to unlock cb_mutex */
+    timer_init(dev, freq, cb_toggle, (void *)(intptr_t)dev);
+
+    test_stats_t stats;
+    uint32_t hist[JITTER_BUCKETS] = { 0 };
+    test_stats_init(&stats);
+
+    unsigned int last = start;
+    for (unsigned i = 0; i < num; i++) {
+        uint32_t diff = test_timer_ticks_diff(dev, last, jitter.samples[i]);
+        int32_t err = (int32_t)(diff - ticks);
+        test_stats_add(&stats, err);
+        hist[_jitter_bucket(err)]++;
+        last = jitter.samples[i];
+    }
+
+    printf("Jitter: hist [");
+    for (unsigned i = 0; i < JITTER_BUCKETS; i++) {
+        printf(i ? ", %"PRIu32 : "%"PRIu32, hist[i]);
+    }
+    puts("]");
+    printf("Success: timer_jitter(): count, mean, min, max, stddev : "
+           "[%"PRIu32", %"PRIi32", %"PRIi32", %"PRIi32", %"PRIu32"]\n",
+           stats.count, test_stats_mean(&stats), stats.min, stats.max,
+           test_stats_stddev(&stats));
+    return RESULT_OK;
+}
+
+static int cmd_get_metadata(int argc, char **argv)
 {
     (void)argv;
     (void)argc;
@@ -324,34 +739,70 @@ int cmd_get_metadata(int argc, char **argv)
     return 0;
 }
 
+static const test_helpers_mem_buf_t mem_bufs[] = {
+    TEST_HELPERS_MEM_BUF(debug_pins),
+    TEST_HELPERS_MEM_BUF(timer_freq),
+    TEST_HELPERS_MEM_BUF(slots),
+    { NULL, 0 }
+};
+
+static int cmd_mem_stats(int argc, char **argv)
+{
+    return test_helpers_mem_stats(0, mem_bufs, argc, argv);
+}
+
+static int cmd_timer_width(int argc, char **argv)
+{
+    return test_timer_width(0, argc, argv);
+}
+
 static const shell_command_t shell_commands[] = {
     { "timer_init", "Initialize timer device", cmd_timer_init },
     { "timer_set", "set timer to relative value", cmd_timer_set },
     { "timer_set_absolute", "set timer to absolute value",
       cmd_timer_set_absolute },
+    { "timer_set_async", "set channels to relative values without waiting",
+      cmd_timer_set_async },
+    { "timer_results", "collect the callbacks of timer_set_async",
+      cmd_timer_results },
     { "timer_clear", "clear timer", cmd_timer_clear },
     { "timer_read", "read timer", cmd_timer_read },
     { "timer_start", "start timer", cmd_timer_start },
     { "timer_stop", "stop timer", cmd_timer_stop },
     { "timer_debug_pin", "config debug pin", cmd_timer_debug_pin },
-    { "timer_read_bench", "execute multiple reads to determine overhead",
+    { "timer_read_bench", "measure the overhead of the timer functions",
       cmd_timer_bench_read },
+    { "timer_jitter", "measure the error of consecutive timer_set callbacks",
+      cmd_timer_jitter },
+    { "timer_width", "measure or set the counter width of a timer",
+      cmd_timer_width },
     { "get_metadata", "Get the metadata of the test firmware",
       cmd_get_metadata },
+    { "mem_stats", "Print the stack and static buffer usage",
+      cmd_mem_stats },
     { NULL, NULL, NULL }
 };
 
-int main(void)
+static void _init(void)
 {
-    puts("Start: Test for the timer API");
-
     /* set all debug pins to undef */
     for (unsigned i = 0; i < TIMER_NUMOF; ++i) {
         debug_pins[i] = GPIO_UNDEF;
     }
+}
+
+#ifdef HIL_COMBINED
+HIL_COMBINED_APP(timer, shell_commands, _init);
+#else
+int main(void)
+{
+    puts("Start: Test for the timer API");
+
+    _init();
 
     char line_buf[SHELL_DEFAULT_BUFSIZE];
     shell_run(shell_commands, line_buf, SHELL_DEFAULT_BUFSIZE);
 
     return 0;
 }
+#endif
@@ -7,13 +7,16 @@
 This module handles parsing of information from RIOT periph_timer_cli test.
 """
 import logging
+import re
 
-from riot_pal import DutShell
+from HilShell import HilShell
 
 
-class PeriphTimerIf(DutShell):
+class PeriphTimerIf(HilShell):
     """Interface to the a node with periph_timer_cli firmware."""
 
+    NAMESPACE = 'timer'
+
     FW_ID = 'periph_timer_cli'
     DEFAULT_TIMER_DEV = 0
     DEFAULT_CHAN = 0
@@ -23,6 +26,8 @@ class PeriphTimerIf(DutShell):
     DEFAULT_CB_NAME = "cb_toggle"
     DEFAULT_DBG_PORT = 0
     DEFAULT_DBG_PIN = 0
+    BENCH_STATS = ['count', 'mean', 'min', 'max']
+    JITTER_STATS = ['count', 'mean', 'min', 'max', 'stddev']
 
 # periph/timer API calls
     def timer_init(self, dev=DEFAULT_TIMER_DEV, freq=DEFAULT_FREQ, cbname=DEFAULT_CB_NAME):
@@ -37,6 +42,45 @@ class PeriphTimerIf(DutShell):
         """Set timer in ticks absolute."""
         return self.send_cmd('timer_set {} {} {}'.format(dev, chan, ticks))
 
+    def timer_set_async(self, dev=DEFAULT_TIMER_DEV, chans=(DEFAULT_CHAN,),
+                        ticks=DEFAULT_TICKS):
+        """Set timer channels in ticks relative without waiting.
+
+        ticks is either used for all chans or a list with a value for each.
+        """
+        if not isinstance(ticks, (list, tuple)):
+            ticks = [ticks] * len(chans)
+        args = ' '.join('{} {}'.format(chan, tick)
+                        for chan, tick in zip(chans, ticks))
+        return self.send_cmd('timer_set_async {} {}'.format(dev, args))
+
+    def timer_results(self, dev=DEFAULT_TIMER_DEV, timeout=None):
+        """Collect the callbacks of timer_set_async.
+
+        The 'fired' dict of the response maps the channels to the armed and
+        fired timestamps and the elapsed ticks, 'armed' maps the channels
+        that are still pending to their armed timestamp.
+        """
+        cmd = 'timer_results {}'.format(dev)
+        lines = self.send_cmd_lines(cmd, timeout=timeout)
+        res = {'cmd': cmd, 'msg': lines[-1], 'fired': {}, 'armed': {},
+               'result': lines[-1].split(':', 1)[0]}
+        for line in lines:
+            match = re.match(r'Result: (\d+) (armed|fired) : \[(.*)\]', line)
+            if not match:
+                continue
+            vals = [int(val) for val in match.group(3).split(',')]
+            if match.group(2) == 'fired':
+                res['fired'][int(match.group(1))] = dict(
+                    zip(['armed', 'fired', 'elapsed'], vals))
+            else:
+                res['armed'][int(match.group(1))] = vals[0]
+        match = re.search(r'\[(.*)\]', lines[-1])
+        res['data'] = []
+        if match:
+            res['data'] = [int(val) for val in match.group(1).split(',')]
+        return res
+
     def timer_clear(self, dev=DEFAULT_TIMER_DEV, chan=DEFAULT_CHAN):
         """Clear timer channel."""
         return self.send_cmd('timer_clear {} {}'.format(dev, chan))
@@ -60,9 +104,61 @@ class PeriphTimerIf(DutShell):
         return self.send_cmd('timer_debug_pin {} {} {}'.format(dev, port, pin))
 
     def timer_read_bench(self, dev=DEFAULT_TIMER_DEV,
-                         repeat_cnt=DEFAULT_REPEAT_CNT):
-        """Bench timer read time overhead."""
-        return self.send_cmd('timer_read_bench {} {}'.format(dev, repeat_cnt))
+                         repeat_cnt=DEFAULT_REPEAT_CNT, chan=DEFAULT_CHAN,
+                         ref_dev=None, timeout=None):
+        """Bench timer read, set, set_absolute and clear time overhead.
+
+        The node times the calls with the CPU cycle counter or, if given,
+        with the initialized timer ref_dev. The 'stats' dict of the response
+        has count, mean, min and max in reference ticks of each function,
+        'loop' the duration of the debug pin bracketed read loop and
+        'ref_hz' the frequency of the reference.
+        """
+        cmd = 'timer_read_bench {} {} {}'.format(dev, repeat_cnt, chan)
+        if ref_dev is not None:
+            cmd += ' {}'.format(ref_dev)
+        lines = self.send_cmd_lines(cmd, timeout=timeout)
+        res = {'cmd': cmd, 'msg': lines[-1], 'stats': {},
+               'result': lines[-1].split(':', 1)[0]}
+        for line in lines:
+            match = re.match(r'Bench: (\w+) (loop )?.*\[(.*)\]', line)
+            if not match:
+                continue
+            vals = [int(val) for val in match.group(3).split(',')]
+            if match.group(2):
+                res['stats']['loop'] = vals[0]
+            else:
+                res['stats'][match.group(1)] = dict(zip(self.BENCH_STATS,
+                                                        vals))
+        res['data'] = [int(val) for val in
+                       re.findall(r'\[(\d+)\]', lines[-1])]
+        if res['data']:
+            res['stats']['ref_hz'] = res['data'][0]
+        return res
+
+    def timer_jitter(self, dev=DEFAULT_TIMER_DEV, chan=DEFAULT_CHAN,
+                     freq=DEFAULT_FREQ, ticks=1000, num=100, timeout=None):
+        """Measure the error of num timer_set callbacks re-armed by ticks.
+
+        The 'stats' dict of the response has count, mean, min, max and
+        stddev of the error in ticks and 'hist' the log2 histogram of the
+        absolute error.
+        """
+        cmd = 'timer_jitter {} {} {} {} {}'.format(dev, chan, freq, ticks, num)
+        lines = self.send_cmd_lines(cmd, timeout=timeout)
+        res = {'cmd': cmd, 'msg': lines[-1], 'stats': {},
+               'result': lines[-1].split(':', 1)[0]}
+        for line in lines:
+            match = re.match(r'Jitter: hist \[(.*)\]', line)
+            if match:
+                res['stats']['hist'] = [int(val) for val in
+                                        match.group(1).split(',')]
+        match = re.search(r'\[(.*)\]', lines[-1])
+        res['data'] = []
+        if match:
+            res['data'] = [int(val) for val in match.group(1).split(',')]
+            res['stats'].update(zip(self.JITTER_STATS, res['data']))
+        return res
 
 # util calls
     def get_metadata(self):
@@ -76,12 +172,15 @@ class PeriphTimerIf(DutShell):
         cmds.append(self.timer_init)
         cmds.append(self.timer_set)
         cmds.append(self.timer_set_absolute)
+        cmds.append(self.timer_set_async)
+        cmds.append(self.timer_results)
         cmds.append(self.timer_clear)
         cmds.append(self.timer_read)
         cmds.append(self.timer_start)
         cmds.append(self.timer_stop)
         cmds.append(self.timer_debug_pin)
         cmds.append(self.timer_read_bench)
+        cmds.append(self.timer_width)
         return cmds
 
 
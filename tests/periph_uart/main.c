@@ -19,23 +19,62 @@
  */
 
 #include <errno.h>
+#include <inttypes.h>
+#include <stdbool.h>
 #include <stdio.h>
 #include <string.h>
 #include <stdlib.h>
 
+#include "bitarithm.h"
 #include "board.h"
+#include "irq.h"
 #include "shell.h"
 #include "thread.h"
 #include "msg.h"
 #include "ringbuffer.h"
+#include "periph/timer.h"
 #include "periph/uart.h"
 #include "stdio_uart.h"
 #include "xtimer.h"
 
 #include "sc_args.h"
+#include "test_helpers.h"
+
+#ifdef HIL_COMBINED
+#include "hil_combined.h"
+#endif
 
 #define SHELL_BUFSIZE       (128U)
+
+/* size of the RX ringbuffer of each device, can be set in the Makefile */
+#ifndef UART_BUFSIZE
 #define UART_BUFSIZE        (128U)
+#endif
+
+/* number of bytes the printer takes from the ringbuffer at once */
+#define PRINTER_CHUNK       (32U)
+
+#ifdef UART_RX_LATENCY
+/* number of log2 buckets of the RX latency histograms */
+#ifndef LATENCY_BUCKETS
+#define LATENCY_BUCKETS     (16U)
+#endif
+
+/* Cortex-M3 and up count CPU cycles in the DWT, else the ticks of the xtimer
+ * timer are read directly, without the conversion of xtimer_now_usec */
+#if defined(DWT) && defined(DWT_CTRL_CYCCNTENA_Msk)
+#define LATENCY_CYCLE_COUNTER
+#define LATENCY_HZ          (CLOCK_CORECLOCK)
+#else
+#define LATENCY_HZ          (XTIMER_HZ)
+#endif
+#endif
+
+/* number of pattern bytes passed to uart_write at once by the bench */
+#define BENCH_CHUNK         (64U)
+
+/* the bench stops waiting for looped back bytes after this idle time */
+#define BENCH_IDLE_TIMEOUT  (20U * US_PER_MS)
 
 #define PRINTER_PRIO        (THREAD_PRIORITY_MAIN - 1)
 #define PRINTER_TYPE        (0xabcd)
@@ -49,6 +88,15 @@
 typedef struct {
     char rx_mem[UART_BUFSIZE];
     ringbuffer_t rx_buf;
+    uint32_t rx_bytes;      /**< bytes received */
+    uint32_t dropped;       /**< bytes dropped as the ringbuffer was full */
+    uint32_t lost;          /**< lines not signaled to the printer */
+    bool bench;             /**< RX bytes are checked instead of printed */
+    uint8_t bench_mask;     /**< mask of the data bits used by the bench */
+    uint8_t bench_last;     /**< last byte received by the bench */
+    uint32_t bench_rx;      /**< bytes received by the bench */
+    uint32_t bench_errors;  /**< bytes that did not match the pattern */
+    uint32_t bench_last_us; /**< time the last bench byte was received */
 } uart_ctx_t;
 
 static uart_ctx_t ctx[UART_NUMOF];
@@ -65,16 +113,127 @@ static uart_stop_bits_t stop_bits_lut[] = { UART_STOP_BITS_1, UART_STOP_BITS_2 }
 static int stop_bits_lut_len = sizeof(stop_bits_lut)/sizeof(stop_bits_lut[0]);
 #endif
 
-static void rx_cb(void *arg, uint8_t data)
+#ifdef UART_RX_LATENCY
+/**
+ * @brief   Histogram of the RX callback timing of a device
+ *
+ * The times are ticks of LATENCY_HZ. Bucket 0 counts 0 ticks, bucket n
+ * counts [2^(n-1), 2^n) ticks and the last bucket everything above.
+ */
+typedef struct {
+    bool started;                           /**< last is valid */
+    uint32_t last;                          /**< entry time of the last call */
+    uint32_t max;                           /**< longest callback duration */
+    uint32_t gap[LATENCY_BUCKETS];          /**< time between callbacks */
+    uint32_t duration[LATENCY_BUCKETS];     /**< duration of the callbacks */
+} latency_t;
+
+static latency_t latency[UART_NUMOF];
+
+static inline uint32_t _latency_now(void)
 {
-    uart_t dev = (uart_t)arg;
+#ifdef LATENCY_CYCLE_COUNTER
+    return DWT->CYCCNT;
+#else
+    return timer_read(XTIMER_DEV);
+#endif
+}
+
+static inline uint32_t _latency_diff(uint32_t a, uint32_t b)
+{
+#ifdef LATENCY_CYCLE_COUNTER
+    return b - a;
+#else
+    /* the xtimer timer may count less than 32 bit */
+    return (b - a) & ~XTIMER_MASK;
+#endif
+}
 
-    ringbuffer_add_one(&(ctx[dev].rx_buf), data);
+static inline unsigned _latency_bucket(uint32_t ticks)
+{
+    if (ticks == 0) {
+        return 0;
+    }
+    unsigned bucket = bitarithm_msb(ticks) + 1;
+    return (bucket < LATENCY_BUCKETS) ? bucket : LATENCY_BUCKETS - 1;
+}
+#endif
+
+static inline void _rx_cb(uart_t dev, uint8_t data)
+{
+    if (ctx[dev].bench) {
+        /* the bench sends the index of each byte as pattern, each byte is
+         * checked against the last one so a lost byte is a single error */
+        uint8_t expected = ctx[dev].bench_rx ? ctx[dev].bench_last + 1 : 0;
+        data &= ctx[dev].bench_mask;
+        if (data != (expected & ctx[dev].bench_mask)) {
+            ctx[dev].bench_errors++;
+        }
+        ctx[dev].bench_last = data;
+        ctx[dev].bench_rx++;
+        ctx[dev].bench_last_us = xtimer_now_usec();
+        return;
+    }
+
+    ctx[dev].rx_bytes++;
+    /* keep the data already received instead of overwriting it */
+    if (ringbuffer_full(&(ctx[dev].rx_buf))) {
+        ctx[dev].dropped++;
+    }
+    else {
+        ringbuffer_add_one(&(ctx[dev].rx_buf), data);
+    }
+    /* signal the line even if the newline was dropped, the printer ends the
+     * line when the ringbuffer is empty */
     if (data == '\n') {
         msg_t msg;
         msg.content.value = (uint32_t)dev;
-        msg_send(&msg, printer_pid);
+        if (msg_send(&msg, printer_pid) <= 0) {
+            ctx[dev].lost++;
+        }
+    }
+}
+
+static void rx_cb(void *arg, uint8_t data)
+{
+    uart_t dev = (uart_t)arg;
+
+#ifdef UART_RX_LATENCY
+    latency_t *lat = &latency[dev];
+    uint32_t now = _latency_now();
+    if (lat->started) {
+        lat->gap[_latency_bucket(_latency_diff(lat->last, now))]++;
+    }
+    lat->started = true;
+    lat->last = now;
+
+    _rx_cb(dev, data);
+
+    uint32_t duration = _latency_diff(now, _latency_now());
+    lat->duration[_latency_bucket(duration)]++;
+    if (duration > lat->max) {
+        lat->max = duration;
+    }
+#else
+    _rx_cb(dev, data);
+#endif
+}
+
+/* takes up to a full line from the ringbuffer, returns the number of bytes */
+static unsigned _get_line_chunk(uart_t dev, char *buf, unsigned size,
+                                bool *eol)
+{
+    unsigned state = irq_disable();
+    unsigned n = ringbuffer_peek(&(ctx[dev].rx_buf), buf, size);
+    char *nl = memchr(buf, '\n', n);
+    if (nl != NULL) {
+        n = nl - buf + 1;
     }
+    ringbuffer_remove(&(ctx[dev].rx_buf), n);
+    irq_restore(state);
+
+    *eol = (nl != NULL) || (n == 0);
+    return n;
 }
 
 static void *printer(void *arg)
@@ -84,24 +243,41 @@ static void *printer(void *arg)
     msg_t msg_queue[8];
     msg_init_queue(msg_queue, 8);
 
+    static const char hex[] = "0123456789abcdef";
+    char chunk[PRINTER_CHUNK];
+    /* a non printable character takes 4 chars as "0x.." */
+    char out[PRINTER_CHUNK * 4];
+
     while (1) {
         msg_receive(&msg);
         uart_t dev = (uart_t)msg.content.value;
-        char c;
+        bool eol = false;
 
+        /* a line is written as a whole between the output of two commands */
+        test_helpers_stdout_lock();
         printf("Success: UART_DEV(%i) RX: [", dev);
-        do {
-            c = (int)ringbuffer_get_one(&(ctx[dev].rx_buf));
-            if (c == '\n') {
-                puts("]\\n");
+        while (!eol) {
+            unsigned n = _get_line_chunk(dev, chunk, sizeof(chunk), &eol);
+            unsigned len = 0;
+            for (unsigned i = 0; i < n; i++) {
+                char c = chunk[i];
+                if (c == '\n') {
+                    break;
+                }
+                else if (c >= ' ' && c <= '~') {
+                    out[len++] = c;
+                }
+                else {
+                    out[len++] = '0';
+                    out[len++] = 'x';
+                    out[len++] = hex[(unsigned char)c >> 4];
+                    out[len++] = hex[c & 0x0f];
+                }
             }
-            else if (c >= ' ' && c <= '~') {
-                printf("%c", c);
-            }
-            else {
-                printf("0x%02x", (unsigned char)c);
-            }
-        } while (c != '\n');
+            fwrite(out, 1, len, stdout);
+        }
+        puts("]\\n");
+        test_helpers_stdout_unlock();
     }
 
     /* this should never be reached */
@@ -248,7 +424,275 @@ static int cmd_uart_write(int argc, char **argv)
     return 0;
 }
 
-int cmd_get_metadata(int argc, char **argv)
+static int cmd_uart_stats(int argc, char **argv)
+{
+    int res = sc_args_check(argc, argv, 1, 2, "DEV [reset]");
+    if (res != ARGS_OK) {
+        return 1;
+    }
+
+    int dev = sc_arg2dev(argv[1], UART_NUMOF);
+    if ((dev < 0) || (UART_DEV(dev) == STDIO_UART_DEV)){
+        return -ENODEV;
+    }
+    if (argc == 3 && strcmp(argv[2], "reset") != 0) {
+        puts("Error: Invalid option, use reset");
+        return 1;
+    }
+
+    unsigned state = irq_disable();
+    uint32_t rx_bytes = ctx[dev].rx_bytes;
+    uint32_t dropped = ctx[dev].dropped;
+    uint32_t lost = ctx[dev].lost;
+    if (argc == 3) {
+        ctx[dev].rx_bytes = 0;
+        ctx[dev].dropped = 0;
+        ctx[dev].lost = 0;
+    }
+    irq_restore(state);
+
+    printf("Success: UART_DEV(%i) rx_bytes, dropped, lost : "
+           "[%"PRIu32", %"PRIu32", %"PRIu32"]\n", dev, rx_bytes, dropped, lost);
+    return 0;
+}
+
+typedef struct {
+    uint32_t rx;            /**< looped back bytes */
+    uint32_t errors;        /**< looped back bytes not matching the pattern */
+    uint32_t missing;       /**< bytes sent but not received */
+    uint32_t duration_us;   /**< time from the first write to the last byte */
+} bench_res_t;
+
+static uint8_t bench_buf[BENCH_CHUNK];
+
+static const uint32_t bench_bauds[] = {
+    9600, 19200, 38400, 57600, 115200, 230400, 460800, 921600, 1000000
+};
+
+#define BENCH_BAUDS_NUMOF   (sizeof(bench_bauds) / sizeof(bench_bauds[0]))
+
+#ifdef MODULE_PERIPH_UART_MODECFG
+static const struct {
+    const char *name;
+    uart_data_bits_t data_bits;
+    uart_parity_t parity;
+    uart_stop_bits_t stop_bits;
+    uint8_t mask;
+} bench_modes[] = {
+    { "8N1", UART_DATA_BITS_8, UART_PARITY_NONE, UART_STOP_BITS_1, 0xff },
+    { "8E1", UART_DATA_BITS_8, UART_PARITY_EVEN, UART_STOP_BITS_1, 0xff },
+    { "8O1", UART_DATA_BITS_8, UART_PARITY_ODD, UART_STOP_BITS_1, 0xff },
+    { "8N2", UART_DATA_BITS_8, UART_PARITY_NONE, UART_STOP_BITS_2, 0xff },
+    { "7E1", UART_DATA_BITS_7, UART_PARITY_EVEN, UART_STOP_BITS_1, 0x7f },
+};
+
+#define BENCH_MODES_NUMOF   (sizeof(bench_modes) / sizeof(bench_modes[0]))
+#endif
+
+static void _bench_run(uart_t dev, uint8_t mask, unsigned len, unsigned iter,
+                       bench_res_t *res)
+{
+    uint32_t sent = 0;
+
+    ctx[dev].bench_mask = mask;
+    ctx[dev].bench_rx = 0;
+    ctx[dev].bench_errors = 0;
+    ctx[dev].bench = true;
+
+    uint32_t start = xtimer_now_usec();
+    for (unsigned i = 0; i < iter; i++) {
+        unsigned left = len;
+        while (left) {
+            unsigned n = (left > BENCH_CHUNK) ? BENCH_CHUNK : left;
+            for (unsigned j = 0; j < n; j++) {
+                bench_buf[j] = (uint8_t)(sent + j) & mask;
+            }
+            uart_write(UART_DEV(dev), bench_buf, n);
+            sent += n;
+            left -= n;
+        }
+    }
+
+    /* wait until all bytes are back or nothing arrives anymore */
+    uint32_t rx;
+    do {
+        rx = ctx[dev].bench_rx;
+        xtimer_usleep(BENCH_IDLE_TIMEOUT);
+    } while (ctx[dev].bench_rx != rx && ctx[dev].bench_rx < sent);
+
+    unsigned state = irq_disable();
+    ctx[dev].bench = false;
+    res->rx = ctx[dev].bench_rx;
+    res->errors = ctx[dev].bench_errors;
+    res->duration_us = res->rx ? ctx[dev].bench_last_us - start : 0;
+    irq_restore(state);
+    res->missing = (sent > res->rx) ? sent - res->rx : 0;
+}
+
+static void _print_bench_res(const bench_res_t *res)
+{
+    uint32_t bytes_per_s = 0;
+    if (res->duration_us) {
+        bytes_per_s = (uint32_t)(((uint64_t)res->rx * US_PER_SEC)
+                                 / res->duration_us);
+    }
+    printf("[%"PRIu32", %"PRIu32", %"PRIu32", %"PRIu32", %"PRIu32"]\n",
+           bytes_per_s, res->rx, res->errors, res->missing, res->duration_us);
+}
+
+static int _bench_init(int dev, uint32_t baud)
+{
+    if (uart_init(UART_DEV(dev), baud, rx_cb, (void *)dev) != UART_OK) {
+        return -1;
+    }
+    return 0;
+}
+
+static int cmd_uart_bench(int argc, char **argv)
+{
+    int res = sc_args_check(argc, argv, 4, 4, "DEV BAUD LEN ITER");
+    if (res != ARGS_OK) {
+        return 1;
+    }
+
+    int dev = sc_arg2dev(argv[1], UART_NUMOF);
+    if ((dev < 0) || (UART_DEV(dev) == STDIO_UART_DEV)){
+        return -ENODEV;
+    }
+
+    uint32_t baud = 0;
+    unsigned len = 0;
+    unsigned iter = 0;
+    if (sc_arg2u32(argv[2], &baud) != ARGS_OK
+        || sc_arg2uint(argv[3], &len) != ARGS_OK
+        || sc_arg2uint(argv[4], &iter) != ARGS_OK) {
+        return 1;
+    }
+    if (len < 1 || iter < 1) {
+        puts("Error: invalid LEN or ITER parameter given");
+        return 1;
+    }
+    if (_bench_init(dev, baud) != 0) {
+        printf("Error: Unable to initialize UART_DEV(%i) at BAUD %"PRIu32"\n",
+               dev, baud);
+        return 1;
+    }
+
+    bench_res_t bench;
+    _bench_run(UART_DEV(dev), 0xff, len, iter, &bench);
+
+    printf("Success: UART_DEV(%i) bench at BAUD %"PRIu32" "
+           "bytes_per_s, rx, errors, missing, duration_us : ", dev, baud);
+    _print_bench_res(&bench);
+    return 0;
+}
+
+static int cmd_uart_bench_sweep(int argc, char **argv)
+{
+    int res = sc_args_check(argc, argv, 3, 3 + BENCH_BAUDS_NUMOF,
+                            "DEV LEN ITER [BAUD...]");
+    if (res != ARGS_OK) {
+        return 1;
+    }
+
+    int dev = sc_arg2dev(argv[1], UART_NUMOF);
+    if ((dev < 0) || (UART_DEV(dev) == STDIO_UART_DEV)){
+        return -ENODEV;
+    }
+
+    unsigned len = 0;
+    unsigned iter = 0;
+    if (sc_arg2uint(argv[2], &len) != ARGS_OK
+        || sc_arg2uint(argv[3], &iter) != ARGS_OK) {
+        return 1;
+    }
+    if (len < 1 || iter < 1) {
+        puts("Error: invalid LEN or ITER parameter given");
+        return 1;
+    }
+
+    uint32_t bauds[BENCH_BAUDS_NUMOF];
+    unsigned bauds_numof = argc - 4;
+    for (unsigned i = 0; i < bauds_numof; i++) {
+        if (sc_arg2u32(argv[4 + i], &bauds[i]) != ARGS_OK) {
+            return 1;
+        }
+    }
+    if (bauds_numof == 0) {
+        memcpy(bauds, bench_bauds, sizeof(bauds));
+        bauds_numof = BENCH_BAUDS_NUMOF;
+    }
+
+    for (unsigned i = 0; i < bauds_numof; i++) {
+        if (_bench_init(dev, bauds[i]) != 0) {
+            printf("Bench: %"PRIu32" unsupported\n", bauds[i]);
+            continue;
+        }
+#ifdef MODULE_PERIPH_UART_MODECFG
+        for (unsigned m = 0; m < BENCH_MODES_NUMOF; m++) {
+            if (uart_mode(UART_DEV(dev), bench_modes[m].data_bits,
+                          bench_modes[m].parity,
+                          bench_modes[m].stop_bits) != UART_OK) {
+                printf("Bench: %"PRIu32" %s unsupported\n",
+                       bauds[i], bench_modes[m].name);
+                continue;
+            }
+            bench_res_t bench;
+            _bench_run(UART_DEV(dev), bench_modes[m].mask, len, iter, &bench);
+            printf("Bench: %"PRIu32" %s : ", bauds[i], bench_modes[m].name);
+            _print_bench_res(&bench);
+        }
+#else
+        bench_res_t bench;
+        _bench_run(UART_DEV(dev), 0xff, len, iter, &bench);
+        printf("Bench: %"PRIu32" 8N1 : ", bauds[i]);
+        _print_bench_res(&bench);
+#endif
+    }
+
+    printf("Success: UART_DEV(%i) bench sweep done\n", dev);
+    return 0;
+}
+
+#ifdef UART_RX_LATENCY
+static void _print_buckets(const char *name, const uint32_t *buckets)
+{
+    printf("Latency: %s [", name);
+    for (unsigned i = 0; i < LATENCY_BUCKETS; i++) {
+        printf(i ? ", %"PRIu32 : "%"PRIu32, buckets[i]);
+    }
+    puts("]");
+}
+
+static int cmd_uart_latency(int argc, char **argv)
+{
+    int res = sc_args_check(argc, argv, 1, 1, "DEV");
+    if (res != ARGS_OK) {
+        return 1;
+    }
+
+    int dev = sc_arg2dev(argv[1], UART_NUMOF);
+    if ((dev < 0) || (UART_DEV(dev) == STDIO_UART_DEV)){
+        return -ENODEV;
+    }
+
+    /* copy and reset at once so no callback is lost in between */
+    latency_t lat;
+    unsigned state = irq_disable();
+    lat = latency[dev];
+    memset(&latency[dev], 0, sizeof(latency[dev]));
+    irq_restore(state);
+
+    _print_buckets("gap_ticks", lat.gap);
+    _print_buckets("duration_ticks", lat.duration);
+    printf("Latency: tick_hz [%"PRIu32"]\n", (uint32_t)LATENCY_HZ);
+    printf("Success: UART_DEV(%i) max duration_us : [%"PRIu32"]\n", dev,
+           (uint32_t)(((uint64_t)lat.max * US_PER_SEC) / LATENCY_HZ));
+    return 0;
+}
+#endif
+
+static int cmd_get_metadata(int argc, char **argv)
 {
     (void)argv;
     (void)argc;
@@ -258,16 +702,87 @@ int cmd_get_metadata(int argc, char **argv)
     return 0;
 }
 
+static const test_helpers_mem_buf_t mem_bufs[] = {
+    TEST_HELPERS_MEM_BUF(ctx),
+    TEST_HELPERS_MEM_BUF(printer_stack),
+#ifdef UART_RX_LATENCY
+    TEST_HELPERS_MEM_BUF(latency),
+#endif
+    TEST_HELPERS_MEM_BUF(bench_buf),
+    { NULL, 0 }
+};
+
+static int cmd_mem_stats(int argc, char **argv)
+{
+    return test_helpers_mem_stats(0, mem_bufs, argc, argv);
+}
+
+/* Runs a command with stdout locked, so the RX lines of the printer thread
+ * cannot end up in the middle of the output of a command. Received bytes
+ * wait in the ringbuffer meanwhile. */
+#define LOCKED_CMD(cmd)                                 \
+    static int cmd##_locked(int argc, char **argv)      \
+    {                                                   \
+        test_helpers_stdout_lock();                     \
+        int res = cmd(argc, argv);                      \
+        test_helpers_stdout_unlock();                   \
+        return res;                                     \
+    }
+
+LOCKED_CMD(cmd_uart_init)
+#ifdef MODULE_PERIPH_UART_MODECFG
+LOCKED_CMD(cmd_uart_mode)
+#endif
+LOCKED_CMD(cmd_uart_write)
+LOCKED_CMD(cmd_uart_stats)
+LOCKED_CMD(cmd_uart_bench)
+LOCKED_CMD(cmd_uart_bench_sweep)
+#ifdef UART_RX_LATENCY
+LOCKED_CMD(cmd_uart_latency)
+#endif
+LOCKED_CMD(cmd_get_metadata)
+LOCKED_CMD(cmd_mem_stats)
+
 static const shell_command_t shell_commands[] = {
-    { "uart_init", "Initialize a UART device with a given baudrate", cmd_uart_init },
+    { "uart_init", "Initialize a UART device with a given baudrate", cmd_uart_init_locked },
 #ifdef MODULE_PERIPH_UART_MODECFG
-    { "uart_mode", "Setup data bits, stop bits and parity for a given UART device", cmd_uart_mode },
+    { "uart_mode", "Setup data bits, stop bits and parity for a given UART device", cmd_uart_mode_locked },
+#endif
+    { "uart_write", "Send a buffer through given UART device", cmd_uart_write_locked },
+    { "uart_stats", "Get or reset the RX counters of a UART device", cmd_uart_stats_locked },
+    { "uart_bench", "Measure the loopback throughput of a UART device", cmd_uart_bench_locked },
+    { "uart_bench_sweep", "Measure the loopback throughput over several baudrates", cmd_uart_bench_sweep_locked },
+#ifdef UART_RX_LATENCY
+    { "uart_latency", "Dump and reset the RX callback timing histograms", cmd_uart_latency_locked },
+#endif
+    { "get_metadata", "Get the metadata of the test firmware", cmd_get_metadata_locked },
+    { "mem_stats", "Print the stack and static buffer usage", cmd_mem_stats_locked },
+#ifdef TEST_HELPERS_STDIO_BAUD
+    TEST_HELPERS_STDIO_BAUD_CMD,
 #endif
-    { "uart_write", "Send a buffer through given UART device", cmd_uart_write },
-    { "get_metadata", "Get the metadata of the test firmware", cmd_get_metadata },
     { NULL, NULL, NULL }
 };
 
+static void _init(void)
+{
+    /* initialize ringbuffers */
+    for (unsigned i = 0; i < UART_NUMOF; i++) {
+        ringbuffer_init(&(ctx[i].rx_buf), ctx[i].rx_mem, UART_BUFSIZE);
+    }
+#ifdef LATENCY_CYCLE_COUNTER
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+#endif
+
+    /* start the printer thread */
+    printer_pid = thread_create(printer_stack, sizeof(printer_stack),
+                                PRINTER_PRIO, THREAD_CREATE_STACKTEST,
+                                printer, NULL, "printer");
+}
+
+#ifdef HIL_COMBINED
+HIL_COMBINED_APP(uart, shell_commands, _init);
+#else
 int main(void)
 {
     puts("\nManual UART driver test application");
@@ -292,17 +807,11 @@ int main(void)
     printf("Available devices:               %i\n", UART_NUMOF);
     printf("UART used for STDIO (the shell): UART_DEV(%i)\n\n", STDIO_UART_DEV);
 
-    /* initialize ringbuffers */
-    for (unsigned i = 0; i < UART_NUMOF; i++) {
-        ringbuffer_init(&(ctx[i].rx_buf), ctx[i].rx_mem, UART_BUFSIZE);
-    }
-
-    /* start the printer thread */
-    printer_pid = thread_create(printer_stack, sizeof(printer_stack),
-                                PRINTER_PRIO, 0, printer, NULL, "printer");
+    _init();
 
     /* run the shell */
     char line_buf[SHELL_DEFAULT_BUFSIZE];
     shell_run(shell_commands, line_buf, SHELL_DEFAULT_BUFSIZE);
     return 0;
 }
+#endif
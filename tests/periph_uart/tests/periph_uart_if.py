@@ -7,13 +7,16 @@
 This module handles parsing of information from RIOT periph_uart test.
 """
 import logging
+import re
 
-from riot_pal import DutShell
+from HilShell import HilShell
 
 
-class PeriphUartIf(DutShell):
+class PeriphUartIf(HilShell):
     """Interface to the node with periph_uart firmware."""
 
+    NAMESPACE = 'uart'
+
     FW_ID = 'periph_uart'
     DEFAULT_BAUD = 115200
     DEFAULT_PARITY = 'N'
@@ -37,6 +40,84 @@ class PeriphUartIf(DutShell):
         """Write data to UART device."""
         return self.send_cmd("uart_write {} {}".format(dev, data))
 
+    def uart_stats(self, dev, reset=False):
+        """Get the RX counters rx_bytes, dropped and lost of a UART device."""
+        if reset:
+            return self.send_cmd("uart_stats {} reset".format(dev))
+        return self.send_cmd("uart_stats {}".format(dev))
+
+    BENCH_RESULTS = ['bytes_per_s', 'rx', 'errors', 'missing', 'duration_us']
+
+    def uart_bench(self, dev, baud=DEFAULT_BAUD, leng=64, iterations=10,
+                   timeout=None):
+        """Measure the loopback throughput of a UART device.
+
+        The results are added to the response as 'stats' dict.
+        """
+        cmd = "uart_bench {} {} {} {}".format(dev, baud, leng, iterations)
+        lines = self.send_cmd_lines(cmd, timeout=timeout)
+        res = {'cmd': cmd, 'msg': lines[-1],
+               'result': lines[-1].split(':', 1)[0]}
+        res['data'] = self._parse_list(lines[-1])
+        res['stats'] = dict(zip(self.BENCH_RESULTS, res['data']))
+        return res
+
+    def uart_bench_sweep(self, dev, leng=64, iterations=10, bauds=None,
+                         timeout=None):
+        """Measure the loopback throughput over several baudrates.
+
+        This needs RX and TX of the device to be connected. The 'stats'
+        dict of the response has the results of each "BAUD MODE", None if
+        the setting is not supported.
+        """
+        cmd = "uart_bench_sweep {} {} {}".format(dev, leng, iterations)
+        if bauds:
+            cmd += ' ' + ' '.join(str(baud) for baud in bauds)
+        lines = self.send_cmd_lines(cmd, timeout=timeout)
+        res = {'cmd': cmd, 'msg': lines[-1], 'data': [], 'stats': {},
+               'result': lines[-1].split(':', 1)[0]}
+        for line in lines:
+            match = re.match(r'Bench: (\d+(?: \w+)?) (?:: (\[.*\])|unsupported)',
+                             line)
+            if match:
+                stats = None
+                if match.group(2):
+                    stats = dict(zip(self.BENCH_RESULTS,
+                                     self._parse_list(match.group(2))))
+                res['stats'][match.group(1)] = stats
+                res['data'].append(line)
+        return res
+
+    def uart_latency(self, dev, timeout=None):
+        """Get and reset the RX callback timing histograms of a UART device.
+
+        Needs a firmware built with UART_RX_LATENCY=1. The 'stats' dict of
+        the response has the 'gap_ticks' and 'duration_ticks' bucket counts,
+        the 'tick_hz' of the ticks and 'max_duration_us'.
+        """
+        cmd = "uart_latency {}".format(dev)
+        lines = self.send_cmd_lines(cmd, timeout=timeout)
+        res = {'cmd': cmd, 'msg': lines[-1], 'stats': {},
+               'result': lines[-1].split(':', 1)[0]}
+        for line in lines:
+            match = re.match(r'Latency: (\w+) (\[.*\])', line)
+            if match:
+                res['stats'][match.group(1)] = self._parse_list(match.group(2))
+        if res['stats'].get('tick_hz'):
+            res['stats']['tick_hz'] = res['stats']['tick_hz'][0]
+        res['data'] = self._parse_list(lines[-1])
+        if res['data']:
+            res['stats']['max_duration_us'] = res['data'][0]
+        return res
+
+    @staticmethod
+    def _parse_list(line):
+        """Get the integers of the list at the end of a line."""
+        match = re.search(r'\[(.*)\]', line)
+        if match is None or not match.group(1).strip():
+            return []
+        return [int(val, 0) for val in match.group(1).split(',')]
+
     def get_metadata(self):
         """Get the metadata of the firmware."""
         return self.send_cmd('get_metadata')
@@ -48,4 +129,5 @@ class PeriphUartIf(DutShell):
         cmds.append(self.uart_init)
         cmds.append(self.uart_mode)
         cmds.append(self.uart_write)
+        cmds.append(self.uart_stats)
         return cmds
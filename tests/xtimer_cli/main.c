@@ -18,12 +18,36 @@
  * @}
  */
 
+#include <inttypes.h>
+#include <stdbool.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 
+#include "cpu.h"
+#include "fmt.h"
 #include "shell.h"
 #include "xtimer.h"
 
+#include "sc_args.h"
+#include "test_helpers.h"
+#include "test_stats.h"
+
+#ifdef HIL_COMBINED
+#include "hil_combined.h"
+#endif
+
+/* Cortex-M3 and up count CPU cycles in the DWT, used by xtimer_overhead */
+#if defined(DWT) && defined(DWT_CTRL_CYCCNTENA_Msk)
+#define OVERHEAD_CYCLE_COUNTER
+#define OVERHEAD_HZ                 (CLOCK_CORECLOCK)
+#else
+#define OVERHEAD_HZ                 (XTIMER_HZ)
+#endif
+
+/* offset of the xtimer_set calls of xtimer_overhead, removed before firing */
+#define OVERHEAD_TIMEOUT_US         (US_PER_SEC)
+
 
 int cmd_xtimer_now(int argc, char **argv)
 {
@@ -35,7 +59,156 @@ int cmd_xtimer_now(int argc, char **argv)
     return 0;
 }
 
-int cmd_get_metadata(int argc, char **argv)
+int cmd_xtimer_now64(int argc, char **argv)
+{
+    (void)argv;
+    (void)argc;
+
+    /* printf of newlib nano has no 64 bit support */
+    char buf[21];
+    buf[fmt_u64_dec(buf, xtimer_now64().ticks64)] = '\0';
+    printf("Success: xtimer_now64(): [%s]\n", buf);
+    return 0;
+}
+
+static void _print_stats(const char *prefix, const char *name,
+                         const test_stats_t *stats)
+{
+    printf("%s: %s count, mean, min, max : "
+           "[%"PRIu32", %"PRIi32", %"PRIi32", %"PRIi32"]\n",
+           prefix, name, stats->count, test_stats_mean(stats),
+           stats->count ? stats->min : 0, stats->count ? stats->max : 0);
+}
+
+int cmd_xtimer_sleep_bench(int argc, char **argv)
+{
+    if (sc_args_check(argc, argv, 3, 3, "usleep|periodic US N") != ARGS_OK) {
+        return ARGS_ERROR;
+    }
+
+    bool periodic;
+    if (strcmp(argv[1], "usleep") == 0) {
+        periodic = false;
+    }
+    else if (strcmp(argv[1], "periodic") == 0) {
+        periodic = true;
+    }
+    else {
+        puts("Error: mode must be usleep or periodic");
+        return ARGS_ERROR;
+    }
+
+    uint32_t us = 0;
+    uint32_t num = 0;
+    if ((sc_arg2u32(argv[2], &us) != ARGS_OK) ||
+        (sc_arg2u32(argv[3], &num) != ARGS_OK)) {
+        return ARGS_ERROR;
+    }
+
+    test_stats_t stats;
+    test_stats_init(&stats);
+
+    xtimer_ticks32_t last = xtimer_now();
+    uint32_t prev = xtimer_now_usec();
+    for (uint32_t i = 0; i < num; i++) {
+        if (periodic) {
+            xtimer_periodic_wakeup(&last, us);
+        }
+        else {
+            xtimer_usleep(us);
+        }
+        uint32_t now = xtimer_now_usec();
+        test_stats_add(&stats, (int32_t)(now - prev));
+        /* usleep measures each call, periodic the distance of the wakeups */
+        prev = periodic ? now : xtimer_now_usec();
+    }
+
+    _print_stats("Bench", argv[1], &stats);
+    printf("Success: xtimer_sleep_bench(): requested_us, error_us : "
+           "[%"PRIu32", %"PRIi32"]\n", us, test_stats_mean(&stats) - (int32_t)us);
+    return 0;
+}
+
+static void _overhead_cb(void *arg)
+{
+    (void)arg;
+}
+
+static inline uint32_t _ticks(void)
+{
+#ifdef OVERHEAD_CYCLE_COUNTER
+    return DWT->CYCCNT;
+#else
+    return xtimer_now().ticks32;
+#endif
+}
+
+/* A single call takes less than a tick of xtimer, so the calls are timed
+ * back to back and only the total is divided by their number */
+static void _print_overhead(const char *name, uint32_t num, uint32_t ticks)
+{
+    uint32_t ns = (uint32_t)(((uint64_t)ticks * NS_PER_SEC) /
+                             ((uint64_t)OVERHEAD_HZ * num));
+    printf("Bench: %s count, ticks, ns : [%"PRIu32", %"PRIu32", %"PRIu32"]\n",
+           name, num, ticks, ns);
+}
+
+int cmd_xtimer_overhead(int argc, char **argv)
+{
+    if (sc_args_check(argc, argv, 1, 1, "N") != ARGS_OK) {
+        return ARGS_ERROR;
+    }
+
+    uint32_t num = 0;
+    if ((sc_arg2u32(argv[1], &num) != ARGS_OK) || (num == 0)) {
+        return ARGS_ERROR;
+    }
+
+#ifdef OVERHEAD_CYCLE_COUNTER
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+#endif
+
+    uint32_t start = _ticks();
+    for (uint32_t i = 0; i < num; i++) {
+        xtimer_now();
+    }
+    _print_overhead("xtimer_now", num, _ticks() - start);
+
+    start = _ticks();
+    for (uint32_t i = 0; i < num; i++) {
+        xtimer_now64();
+    }
+    _print_overhead("xtimer_now64", num, _ticks() - start);
+
+    start = _ticks();
+    for (uint32_t i = 0; i < num; i++) {
+        xtimer_now_usec();
+    }
+    _print_overhead("xtimer_now_usec", num, _ticks() - start);
+
+    /* setting a pending timer removes it first, as a set of a new timer */
+    xtimer_t timer = { .callback = _overhead_cb };
+    start = _ticks();
+    for (uint32_t i = 0; i < num; i++) {
+        xtimer_set(&timer, OVERHEAD_TIMEOUT_US);
+    }
+    _print_overhead("xtimer_set", num, _ticks() - start);
+    xtimer_remove(&timer);
+
+    start = _ticks();
+    for (uint32_t i = 0; i < num; i++) {
+        xtimer_set(&timer, OVERHEAD_TIMEOUT_US);
+        xtimer_remove(&timer);
+    }
+    _print_overhead("xtimer_set_remove", num, _ticks() - start);
+
+    printf("Success: xtimer_overhead(): ticks_hz : [%lu]\n",
+           (unsigned long)OVERHEAD_HZ);
+    return 0;
+}
+
+static int cmd_get_metadata(int argc, char **argv)
 {
     (void)argv;
     (void)argc;
@@ -45,12 +218,27 @@ int cmd_get_metadata(int argc, char **argv)
     return 0;
 }
 
+static int cmd_mem_stats(int argc, char **argv)
+{
+    return test_helpers_mem_stats(0, NULL, argc, argv);
+}
+
 static const shell_command_t shell_commands[] = {
     { "xtimer_now", "Get number of ticks (32Bit) from xtimer", cmd_xtimer_now },
+    { "xtimer_now64", "Get number of ticks (64Bit) from xtimer", cmd_xtimer_now64 },
+    { "xtimer_sleep_bench", "Measure the duration of N sleeps", cmd_xtimer_sleep_bench },
+    { "xtimer_overhead", "Measure the cost of the xtimer calls in ticks", cmd_xtimer_overhead },
     { "get_metadata", "Get the metadata of the test firmware", cmd_get_metadata },
+    { "mem_stats", "Print the stack and static buffer usage", cmd_mem_stats },
+#ifdef TEST_HELPERS_STDIO_BAUD
+    TEST_HELPERS_STDIO_BAUD_CMD,
+#endif
     { NULL, NULL, NULL }
 };
 
+#ifdef HIL_COMBINED
+HIL_COMBINED_APP(xtimer, shell_commands, NULL);
+#else
 int main(void)
 {
     puts("Start: Test for the xtimer API");
@@ -60,3 +248,4 @@ int main(void)
 
     return 0;
 }
+#endif
@@ -7,14 +7,19 @@
 This module handles parsing of information from RIOT xtimer_cli test.
 """
 import logging
+import re
 
-from riot_pal import DutShell
+from HilShell import HilShell
 
 
-class XtimerIf(DutShell):
+class XtimerIf(HilShell):
     """Interface to the a node with xtimer_cli firmware."""
 
+    NAMESPACE = 'xtimer'
+
     FW_ID = 'xtimer_cli'
+    BENCH_STATS = ['count', 'mean', 'min', 'max']
+    OVERHEAD_STATS = ['count', 'ticks', 'ns']
 
     def __init__(self, *args, **kwargs):
         super().__init__(*args, **kwargs)
@@ -27,6 +32,57 @@ class XtimerIf(DutShell):
         """Get current timer ticks."""
         return self.send_cmd('xtimer_now')
 
+    def xtimer_now64(self):
+        """Get current timer ticks as 64 bit value."""
+        return self.send_cmd('xtimer_now64')
+
+    def xtimer_sleep_bench(self, mode='usleep', usec=1000, num=100,
+                           timeout=None):
+        """Measure the duration of num sleeps of usec on the node.
+
+        mode is 'usleep' for xtimer_usleep or 'periodic' for
+        xtimer_periodic_wakeup. The 'stats' dict of the response has count,
+        mean, min and max of the measured duration in us, 'requested_us'
+        and 'error_us', the mean minus the requested duration, with its
+        absolute value in 'abs_error_us'.
+        """
+        cmd = 'xtimer_sleep_bench {} {} {}'.format(mode, usec, num)
+        res = self._bench_cmd(cmd, timeout)
+        res['stats'] = res['stats'].get(mode, {})
+        res['stats'].update(zip(['requested_us', 'error_us'], res['data']))
+        if 'error_us' in res['stats']:
+            res['stats']['abs_error_us'] = abs(res['stats']['error_us'])
+        return res
+
+    def xtimer_overhead(self, num=1000, timeout=None):
+        """Measure the cost of the xtimer calls on the node.
+
+        The 'stats' dict of the response maps each call to the count of back
+        to back calls, their total ticks and the ns per call, 'ticks_hz' is
+        the tick frequency.
+        """
+        res = self._bench_cmd('xtimer_overhead {}'.format(num), timeout,
+                              self.OVERHEAD_STATS)
+        if res['data']:
+            res['stats']['ticks_hz'] = res['data'][0]
+        return res
+
+    def _bench_cmd(self, cmd, timeout, fields=BENCH_STATS):
+        """Send a command that prints Bench: lines before its result."""
+        lines = self.send_cmd_lines(cmd, timeout=timeout)
+        res = {'cmd': cmd, 'msg': lines[-1], 'stats': {}, 'data': [],
+               'result': lines[-1].split(':', 1)[0]}
+        for line in lines:
+            match = re.match(r'Bench: (\w+) .*\[(.*)\]', line)
+            if match:
+                res['stats'][match.group(1)] = dict(zip(
+                    fields,
+                    [int(val) for val in match.group(2).split(',')]))
+        match = re.search(r'\[(.*)\]', lines[-1])
+        if match:
+            res['data'] = [int(val) for val in match.group(1).split(',')]
+        return res
+
     def get_metadata(self):
         """Get the metadata of the firmware."""
         return self.send_cmd('get_metadata')
@@ -36,6 +92,9 @@ class XtimerIf(DutShell):
         cmds = list()
         cmds.append(self.get_metadata)
         cmds.append(self.xtimer_now)
+        cmds.append(self.xtimer_now64)
+        cmds.append(self.xtimer_sleep_bench)
+        cmds.append(self.xtimer_overhead)
         return cmds
 
 
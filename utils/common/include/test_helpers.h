@@ -51,6 +51,94 @@
 
 #endif /* JSON_SHELL_PARSER */
 
+#ifdef BIN_SHELL_PARSER
+#ifdef JSON_SHELL_PARSER
+#error "JSON_SHELL_PARSER and BIN_SHELL_PARSER cannot be used together"
+#endif
+/**
+ * @name    BIN_SHELL_PARSER states
+ *
+ * Used to control the state of writing binary formatted message.
+ * @{
+ */
+#define BIN_STATE_READY             0
+#define BIN_STATE_STARTED           0x01
+#define BIN_STATE_DATA_STARTED      0x02
+/** @} */
+
+/**
+ * @brief   The number of binary shell parsers in case using multiple threads
+ * @{
+ */
+#ifndef NUM_OF_BIN_SHELL_PARSER
+#define NUM_OF_BIN_SHELL_PARSER     1
+#endif
+/** @} */
+
+/**
+ * @name    BIN_SHELL_PARSER frame format
+ *
+ * A response is sent in one or more frames:
+ *
+ *     | SOF | FLAGS | LEN (LE16) | PAYLOAD (LEN bytes) | CRC (LE16) |
+ *
+ * The payloads of all frames up to and including the one with
+ * BIN_FRAME_FLAG_LAST set form a single CBOR map with the keys "cmd", "data"
+ * and "result", the same keys used with JSON_SHELL_PARSER. The frames of a
+ * response are never interleaved with the frames of another response.
+ * The CRC is a CRC-16/CCITT-FALSE over FLAGS, LEN and PAYLOAD.
+ * @{
+ */
+#define BIN_FRAME_SOF               (0xB5)
+#define BIN_FRAME_FLAG_LAST         (0x01)
+#define BIN_FRAME_HDR_LEN           (4U)
+#define BIN_FRAME_CRC_LEN           (2U)
+/** @} */
+
+/**
+ * @brief   The version of parser being used
+ */
+#define APP_SHELL_FMT    "BIN_SHELL_PARSER_v0.0.0"
+
+#endif /* BIN_SHELL_PARSER */
+
+/**
+ * @brief   Size of the output buffer of each parsing instance
+ *
+ * All parts of a response are collected in this buffer and written to stdio
+ * at once when the result is printed, or earlier if the buffer is full.
+ */
+#ifndef TEST_HELPERS_BUFSIZE
+#define TEST_HELPERS_BUFSIZE        (128U)
+#endif
+
+#if defined(TEST_HELPERS_DURATION) || defined(DOXYGEN)
+/**
+ * @name    Command duration instrumentation
+ *
+ * With TEST_HELPERS_DURATION (`USE_CMD_DURATION=1`) print_cmd() starts a
+ * timer for the parsing instance and print_result() adds the elapsed time
+ * as "duration_us" to the response. The calls of the shell commands are
+ * timed on their own and summed up per shell command name, including the
+ * commands that print no command name, see test_helpers_profile_commands().
+ * @{
+ */
+/**
+ * @brief   Maximum length of a command name including the terminator
+ */
+#ifndef TEST_HELPERS_CMD_NAME_LEN
+#define TEST_HELPERS_CMD_NAME_LEN   (24U)
+#endif
+
+/**
+ * @brief   Number of different commands that are profiled
+ */
+#ifndef TEST_HELPERS_PROFILE_NUMOF
+#define TEST_HELPERS_PROFILE_NUMOF  (32U)
+#endif
+/** @} */
+#endif /* TEST_HELPERS_DURATION */
+
 /**
  * @name    TEST_RESULT standard states
  *
@@ -61,11 +149,51 @@
 #define TEST_RESULT_ERROR   "Error"
 /** @} */
 
+/**
+ * @brief   Initial value of a test_helpers_crc16() checksum
+ */
+#define TEST_HELPERS_CRC16_INIT     (0xFFFF)
+
+/**
+ * @brief   Updates a CRC-16/CCITT-FALSE checksum with the given bytes
+ *
+ * This is the checksum of the BIN_SHELL_PARSER frames, commands can use it
+ * to protect data they send independent of the parser.
+ *
+ * @param[in] crc   the checksum so far or TEST_HELPERS_CRC16_INIT
+ * @param[in] buf   the bytes to add
+ * @param[in] len   the number of bytes
+ *
+ * @return  the updated checksum
+ */
+uint16_t test_helpers_crc16(uint16_t crc, const uint8_t *buf, size_t len);
+
+/**
+ * @brief   Locks stdout for other users of the test helpers
+ *
+ * Responses are only written to stdout while holding this lock, code that
+ * writes to stdout directly can take it to keep its output from being
+ * interleaved with a response of another thread. The lock can be taken
+ * several times by the same thread.
+ */
+void test_helpers_stdout_lock(void);
+
+/**
+ * @brief   Releases the lock taken by test_helpers_stdout_lock()
+ */
+void test_helpers_stdout_unlock(void);
+
 /**
  * @brief   Prints the command that was issued to the console
  *
  * The exact output depends on the parser but it will contain information on
- * the command.
+ * the command. For a parsing instance other than 0 the JSON and binary
+ * parsers add the key "dev" so responses of concurrent threads can be told
+ * apart.
+ *
+ * @note    Each parsing instance belongs to the calling thread from its first
+ *          output until print_result(), other threads using the same
+ *          instance block until then. Must not be called from interrupts.
  *
  * @param[in] dev   parsing instance
  * @param[in] cmd   string of the command
@@ -84,6 +212,18 @@ void print_cmd(int dev, char *cmd);
  */
 void print_data_dict_str(int dev, char *key, char *val);
 
+/**
+ * @brief   Prints a key value where the value is an integer to the console
+ *
+ * The exact output depends on the parser but it will contain information on
+ * both the key and value.
+ *
+ * @param[in] dev   parsing instance
+ * @param[in] key   string of the key
+ * @param[in] val   the integer value
+ */
+void print_data_dict_int(int dev, char *key, int32_t val);
+
 /**
  * @brief   Prints a int to the console
  *
@@ -106,6 +246,51 @@ void print_data_int(int dev, int32_t data);
  */
 void print_data_str(int dev, char *str);
 
+/**
+ * @brief   Prints a buffer of bytes to the console
+ *
+ * The bytes are written as a single data entry, as a hex string for text
+ * based parsers or as a byte string for the binary parser.
+ *
+ * @param[in] dev   parsing instance
+ * @param[in] data  the bytes to print
+ * @param[in] len   the number of bytes
+ */
+void print_data_bytes(int dev, const uint8_t *data, size_t len);
+
+/**
+ * @brief   Prints an array of integers to the console
+ *
+ * The array is written as a single data entry containing all values.
+ *
+ * @param[in] dev   parsing instance
+ * @param[in] data  the integers to print
+ * @param[in] len   the number of integers
+ */
+void print_data_int_array(int dev, const int32_t *data, size_t len);
+
+/**
+ * @brief   Prints an array of 16 bit unsigned integers to the console
+ *
+ * @see     print_data_int_array
+ *
+ * @param[in] dev   parsing instance
+ * @param[in] data  the integers to print
+ * @param[in] len   the number of integers
+ */
+void print_data_u16_array(int dev, const uint16_t *data, size_t len);
+
+/**
+ * @brief   Prints an array of 32 bit unsigned integers to the console
+ *
+ * @see     print_data_int_array
+ *
+ * @param[in] dev   parsing instance
+ * @param[in] data  the integers to print
+ * @param[in] len   the number of integers
+ */
+void print_data_u32_array(int dev, const uint32_t *data, size_t len);
+
 /**
  * @brief   Prints a result to the console
  *
@@ -113,10 +298,213 @@ void print_data_str(int dev, char *str);
  * the string.
  *
  * @note    This must be used for some parsers to indicate end of command
+ * @note    This writes the buffered response of @p dev to the console
  *
  * @param[in] dev   parsing instance
  * @param[in] res   the TEST_RESULT string if SUCCESS or ERROR
  */
 void print_result(int dev, char *res);
 
+/**
+ * @brief   Usage of the batch command
+ */
+#define TEST_HELPERS_BATCH_USAGE    "batch [-e] CMD [ARGS] [; CMD [ARGS]]..."
+
+/**
+ * @brief   Runs several shell commands and prints all results in one response
+ *
+ * The arguments are split at ";" into shell commands that are run in order
+ * from @p cmds. The output of each command is nested in the data of the
+ * batch response, which is written to the console once all commands ran.
+ * With "-e" as the first argument the batch stops at the first command
+ * that fails.
+ *
+ * @note    Nested batches are not supported
+ *
+ * @param[in] dev   parsing instance
+ * @param[in] cmds  shell commands of the application
+ * @param[in] argc  number of arguments
+ * @param[in] argv  arguments, the ";" separators are modified in place
+ *
+ * @return  0 if all commands succeeded
+ * @return  -1 if a command failed
+ */
+int test_helpers_batch(int dev, const shell_command_t *cmds,
+                       int argc, char **argv);
+
+/**
+ * @brief   Usage of the mem_stats command
+ */
+#define TEST_HELPERS_MEM_STATS_USAGE    "mem_stats"
+
+/**
+ * @brief   Static buffer of an application reported by mem_stats
+ */
+typedef struct {
+    const char *name;   /**< name of the buffer, NULL ends a table */
+    size_t size;        /**< size of the buffer in bytes */
+} test_helpers_mem_buf_t;
+
+/**
+ * @brief   Initializer of a test_helpers_mem_buf_t entry for @p buf
+ */
+#define TEST_HELPERS_MEM_BUF(buf)   { #buf, sizeof(buf) }
+
+/**
+ * @brief   Maximum length of a mem_stats key including the terminator
+ *
+ * Longer thread and buffer names are truncated to fit their suffix.
+ */
+#ifndef TEST_HELPERS_MEM_KEY_LEN
+#define TEST_HELPERS_MEM_KEY_LEN    (32U)
+#endif
+
+/**
+ * @brief   Prints the stack and static buffer usage of the application
+ *
+ * With DEVELHELP, "NAME_stack_size" and "NAME_stack_used" are written for
+ * every thread, where the used bytes are the high-water mark of threads
+ * created with THREAD_CREATE_STACKTEST, and "isr_stack_used" if the CPU
+ * can measure it. "NAME_size" is written for the scratch arena and every
+ * buffer of @p bufs, "scratch_max_used" for the highest fill level of the
+ * arena and "static_total" for the sum of all buffers.
+ *
+ * @param[in] dev   parsing instance
+ * @param[in] bufs  static buffers of the application ending with a NULL
+ *                  name, may be NULL
+ * @param[in] argc  number of arguments
+ * @param[in] argv  arguments
+ *
+ * @return  0 on success
+ * @return  -1 on invalid arguments
+ */
+int test_helpers_mem_stats(int dev, const test_helpers_mem_buf_t *bufs,
+                           int argc, char **argv);
+
+#if defined(TEST_HELPERS_DURATION) || defined(DOXYGEN)
+/**
+ * @brief   Usage of the profile command
+ */
+#define TEST_HELPERS_PROFILE_USAGE  "profile [reset]"
+
+/**
+ * @brief   Prints the number of calls and the total duration of each command
+ *
+ * For every command of @p cmds that printed a result, the keys
+ * "NAME_count" and "NAME_us" are written to the data of the response.
+ * With "reset" as argument the profile is cleared afterwards.
+ *
+ * @param[in] dev   parsing instance
+ * @param[in] cmds  shell commands of the application
+ * @param[in] argc  number of arguments
+ * @param[in] argv  arguments
+ *
+ * @return  0 on success
+ * @return  -1 on invalid arguments
+ */
+int test_helpers_profile(int dev, const shell_command_t *cmds,
+                         int argc, char **argv);
+
+/**
+ * @brief   Returns the shell commands with every call profiled
+ *
+ * The returned table has the names of @p cmds, each handler is replaced by
+ * one that runs the command and adds its duration to the profile under the
+ * name of the shell command. Pass it to shell_run() instead of @p cmds, the
+ * commands of a batch are profiled the same way.
+ *
+ * @param[in] cmds  shell commands of the application
+ *
+ * @return  the profiled commands
+ * @return  @p cmds if it has more than TEST_HELPERS_PROFILE_NUMOF commands
+ */
+const shell_command_t *test_helpers_profile_commands(const shell_command_t *cmds);
+
+/**
+ * @brief   Runs a shell command and adds its duration to the profile under
+ *          the name of @p cmd
+ *
+ * For dispatchers that do not pass a table to shell_run(), such as the
+ * namespaces of the combined firmware.
+ *
+ * @param[in] cmd   shell command to run
+ * @param[in] argc  number of arguments
+ * @param[in] argv  arguments, argv[0] is the command name
+ *
+ * @return  the result of the command
+ */
+int test_helpers_profile_call(const shell_command_t *cmd, int argc, char **argv);
+#endif
+
+#if defined(TEST_HELPERS_STDIO_BAUD) || defined(DOXYGEN)
+/**
+ * @name    Runtime baudrate of the stdio UART
+ *
+ * With TEST_HELPERS_STDIO_BAUD (`USE_STDIO_BAUD=1`) the host can switch the
+ * baudrate of STDIO_UART_DEV at runtime, see test_helpers_stdio_baud().
+ * @{
+ */
+/**
+ * @brief   Usage of the stdio_baud command
+ */
+#define TEST_HELPERS_STDIO_BAUD_USAGE   "stdio_baud BAUD [TIMEOUT_MS]"
+
+/**
+ * @brief   Line the host sends at the new rate to confirm it
+ */
+#define TEST_HELPERS_STDIO_BAUD_CONFIRM "stdio_baud_ok"
+
+/**
+ * @brief   Default time to wait for the confirmation in ms
+ */
+#ifndef TEST_HELPERS_STDIO_BAUD_TIMEOUT_MS
+#define TEST_HELPERS_STDIO_BAUD_TIMEOUT_MS  (1000U)
+#endif
+
+/**
+ * @brief   Number of characters to wait for before changing the rate
+ *
+ * This gives the response time to leave the UART at the old rate. The
+ * shell prompt follows when the command returns, at the rate it ends with.
+ */
+#ifndef TEST_HELPERS_STDIO_BAUD_DRAIN
+#define TEST_HELPERS_STDIO_BAUD_DRAIN       (64U)
+#endif
+/** @} */
+
+/**
+ * @brief   Switches the stdio UART to another baudrate after a handshake
+ *
+ * The response is written at the current rate, then the UART is switched
+ * to BAUD and waits for the host to send TEST_HELPERS_STDIO_BAUD_CONFIRM
+ * at the new rate within TIMEOUT_MS. A second response "stdio_baud_confirm"
+ * succeeds at the new rate, or fails at the previous rate the UART fell
+ * back to when the host did not confirm in time.
+ *
+ * @note    Not supported in a batch, the response has to be written before
+ *          the rate changes
+ *
+ * @param[in] dev   parsing instance
+ * @param[in] argc  number of arguments
+ * @param[in] argv  arguments
+ *
+ * @return  0 if the new rate is used
+ * @return  -1 on invalid arguments or if the UART fell back
+ */
+int test_helpers_stdio_baud(int dev, int argc, char **argv);
+
+/**
+ * @brief   Shell handler of stdio_baud, runs test_helpers_stdio_baud() on
+ *          parsing instance 0
+ */
+int test_helpers_stdio_baud_cmd(int argc, char **argv);
+
+/**
+ * @brief   Shell command entry of stdio_baud for the shell_commands of an app
+ */
+#define TEST_HELPERS_STDIO_BAUD_CMD \
+    { "stdio_baud", "Switch the stdio UART to another baudrate", \
+      test_helpers_stdio_baud_cmd }
+#endif
+
 #endif /* TEST_HELPERS_H */
@@ -0,0 +1,89 @@
+/*
+ * Copyright (C) 2019 HAW Hamburg
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+/**
+ * @ingroup tests
+ * @{
+ *
+ * @file
+ * @brief       Scratch arena the commands of the tests borrow buffers from.
+ *
+ * The size is a build setting, `HIL_SCRATCH_SIZE` in the board env files,
+ * so the same command can transfer more data on boards with more RAM.
+ * The arena is not thread safe, it is meant for the shell thread.
+ *
+ * @}
+ */
+
+#ifndef TEST_SCRATCH_H
+#define TEST_SCRATCH_H
+
+#include <stddef.h>
+
+/**
+ * @brief   Size of the scratch arena in bytes
+ */
+#ifndef TEST_SCRATCH_SIZE
+#define TEST_SCRATCH_SIZE       (512U)
+#endif
+
+/**
+ * @brief   Alignment of the borrowed buffers
+ */
+#define TEST_SCRATCH_ALIGN      (sizeof(void *))
+
+/**
+ * @brief   Borrows a buffer from the scratch arena
+ *
+ * The buffer is valid until it is returned by test_scratch_release() or
+ * test_scratch_reset().
+ *
+ * @param[in] len   number of bytes
+ *
+ * @return  the buffer, aligned to TEST_SCRATCH_ALIGN
+ * @return  NULL if the arena has not enough bytes left
+ */
+void *test_scratch_alloc(size_t len);
+
+/**
+ * @brief   Gets the current fill level of the arena
+ *
+ * @return  mark to pass to test_scratch_release()
+ */
+size_t test_scratch_mark(void);
+
+/**
+ * @brief   Returns all buffers borrowed since @p mark was taken
+ *
+ * @param[in] mark  the fill level from test_scratch_mark()
+ */
+void test_scratch_release(size_t mark);
+
+/**
+ * @brief   Returns all borrowed buffers
+ *
+ * Commands call this before borrowing so returning early needs no cleanup,
+ * the buffers of a command are not used after it finished.
+ */
+void test_scratch_reset(void);
+
+/**
+ * @brief   Gets the number of bytes that can still be borrowed
+ *
+ * @return  the bytes left in the arena
+ */
+size_t test_scratch_available(void);
+
+/**
+ * @brief   Gets the highest fill level of the arena since boot
+ *
+ * @return  the most bytes borrowed at the same time
+ */
+size_t test_scratch_max_used(void);
+
+#endif /* TEST_SCRATCH_H */
@@ -0,0 +1,80 @@
+/*
+ * Copyright (C) 2019 HAW Hamburg
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+/**
+ * @ingroup tests
+ * @{
+ *
+ * @file
+ * @brief       Simple statistics for benchmark commands of the tests.
+ *
+ * @}
+ */
+
+#ifndef TEST_STATS_H
+#define TEST_STATS_H
+
+#include <stdint.h>
+
+/**
+ * @brief   Running statistics of a series of samples
+ */
+typedef struct {
+    uint32_t count;     /**< number of samples */
+    int32_t min;        /**< smallest sample */
+    int32_t max;        /**< largest sample */
+    int64_t sum;        /**< sum of all samples */
+    uint64_t sum_sq;    /**< sum of the squares of all samples */
+} test_stats_t;
+
+/**
+ * @brief   Resets the statistics
+ *
+ * @param[out] stats    the statistics
+ */
+void test_stats_init(test_stats_t *stats);
+
+/**
+ * @brief   Adds a sample to the statistics
+ *
+ * @param[in,out] stats the statistics
+ * @param[in] val       the sample
+ */
+void test_stats_add(test_stats_t *stats, int32_t val);
+
+/**
+ * @brief   Gets the mean of all samples
+ *
+ * @param[in] stats     the statistics
+ *
+ * @return  the mean, 0 if there are no samples
+ */
+int32_t test_stats_mean(const test_stats_t *stats);
+
+/**
+ * @brief   Gets the standard deviation of all samples
+ *
+ * @param[in] stats     the statistics
+ *
+ * @return  the standard deviation, 0 if there are no samples
+ */
+uint32_t test_stats_stddev(const test_stats_t *stats);
+
+/**
+ * @brief   Prints the statistics to the console
+ *
+ * Each value is printed as key value pair where the key is @p prefix
+ * followed by "_count", "_min", "_max", "_mean" or "_stddev".
+ *
+ * @param[in] dev       parsing instance
+ * @param[in] prefix    prefix of the keys
+ * @param[in] stats     the statistics
+ */
+void print_data_stats(int dev, const char *prefix, const test_stats_t *stats);
+
+#endif /* TEST_STATS_H */
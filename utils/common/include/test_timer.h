@@ -0,0 +1,75 @@
+/*
+ * Copyright (C) 2019 HAW Hamburg
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+/**
+ * @ingroup tests
+ * @{
+ *
+ * @file
+ * @brief       Width of the periph_timer counters for the timer tests.
+ *
+ * Timers count with 8 to 32 bit, so the ticks between two reads of a counter
+ * that wrapped in between are only right if the difference is masked with
+ * the width of that timer. The width is taken from TEST_TIMER_WIDTH, set by
+ * `HIL_PERIPH_TIMER_WIDTH` in the board config, or else measured once by the
+ * host with the timer_width command and set again after every reset.
+ *
+ * @}
+ */
+
+#ifndef TEST_TIMER_H
+#define TEST_TIMER_H
+
+#include <stdint.h>
+
+#include "periph/timer.h"
+
+/**
+ * @brief   Usage of the timer_width command
+ */
+#define TEST_TIMER_WIDTH_USAGE  "timer_width DEV [BITS]"
+
+/**
+ * @brief   Ticks to read a counter without a wrap before it counts as 32 bit
+ */
+#ifndef TEST_TIMER_WIDTH_LIMIT
+#define TEST_TIMER_WIDTH_LIMIT  (0x1000000UL)
+#endif
+
+/**
+ * @brief   Ticks from @p a to @p b of a timer, counting over a wrap
+ *
+ * @param[in] dev   timer both values were read from
+ * @param[in] a     earlier value
+ * @param[in] b     later value
+ *
+ * @return  ticks from @p a to @p b modulo the width of @p dev, which is
+ *          TEST_TIMER_WIDTH or 32 bit as long as it was not set with
+ *          test_timer_width()
+ */
+uint32_t test_timer_ticks_diff(tim_t dev, uint32_t a, uint32_t b);
+
+/**
+ * @brief   Measures or sets the width of a timer
+ *
+ * With BITS the width of DEV is set. Without it the width is
+ * TEST_TIMER_WIDTH if the board config defines it, else it is measured by
+ * reading the initialized and running timer until it wraps. A counter that
+ * did not wrap within TEST_TIMER_WIDTH_LIMIT ticks counts as 32 bit, so the
+ * measurement blocks for up to that many ticks. The data is the width in bit.
+ *
+ * @param[in] dev   parsing instance
+ * @param[in] argc  number of arguments
+ * @param[in] argv  arguments
+ *
+ * @return  0 on success
+ * @return  -1 on invalid arguments or if the timer does not count
+ */
+int test_timer_width(int dev, int argc, char **argv);
+
+#endif /* TEST_TIMER_H */
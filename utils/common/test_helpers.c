@@ -20,100 +20,1012 @@
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
 #include <assert.h>
 #include <inttypes.h>
 
+#include "fmt.h"
+#include "mutex.h"
+#include "rmutex.h"
+#include "thread.h"
 #include "test_helpers.h"
+#include "test_scratch.h"
+#if defined(TEST_HELPERS_DURATION) || defined(TEST_HELPERS_STDIO_BAUD)
+#include "xtimer.h"
+#endif
+#ifdef TEST_HELPERS_STDIO_BAUD
+#include "isrpipe/read_timeout.h"
+#include "periph/uart.h"
+#include "stdio_uart.h"
+#endif
+#ifdef TEST_HELPERS_STDIO_BAUD
+#include "sc_args.h"
+#endif
+
+#if defined(JSON_SHELL_PARSER)
+#define OUTBUF_NUMOF    NUM_OF_JSON_SHELL_PARSER
+#elif defined(BIN_SHELL_PARSER)
+#define OUTBUF_NUMOF    NUM_OF_BIN_SHELL_PARSER
+#else
+#define OUTBUF_NUMOF    (1U)
+#endif
+
+#ifdef BIN_SHELL_PARSER
+#define OUTBUF_HDR_LEN  BIN_FRAME_HDR_LEN
+#define OUTBUF_CRC_LEN  BIN_FRAME_CRC_LEN
+#else
+#define OUTBUF_HDR_LEN  (0U)
+#define OUTBUF_CRC_LEN  (0U)
+#endif
+
+#ifdef BIN_SHELL_PARSER
+/**
+ * @name    CBOR major types and simple values
+ * @{
+ */
+#define CBOR_UINT           (0x00)
+#define CBOR_NINT           (0x20)
+#define CBOR_BYTES          (0x40)
+#define CBOR_TEXT           (0x60)
+#define CBOR_ARRAY          (0x80)
+#define CBOR_MAP            (0xA0)
+#define CBOR_INDEFINITE     (0x1F)
+#define CBOR_BREAK          (0xFF)
+/** @} */
+#endif
+
+#define CRC16_CCITT_POLY    (0x1021)
+
+typedef struct {
+    mutex_t lock;           /**< held from the first output to the result */
+    kernel_pid_t owner;     /**< thread holding the lock */
+    bool flushing;          /**< the response holds the stdout lock */
+    bool nested;            /**< a batch is collecting the output */
+    bool nested_error;      /**< a command of the batch failed */
+    unsigned nested_count;  /**< number of responses in the batch */
+#ifdef TEST_HELPERS_DURATION
+    uint32_t start_us;      /**< time of print_cmd */
+    char cmd[TEST_HELPERS_CMD_NAME_LEN];    /**< name of the command */
+#endif
+    size_t len;
+    char buf[OUTBUF_HDR_LEN + TEST_HELPERS_BUFSIZE + OUTBUF_CRC_LEN];
+} outbuf_t;
+
+static outbuf_t outbuf[OUTBUF_NUMOF];
+
+/* keeps the frames of a response together on stdout */
+static rmutex_t stdout_lock = RMUTEX_INIT;
+
+#ifdef TEST_HELPERS_DURATION
+typedef struct {
+    char name[TEST_HELPERS_CMD_NAME_LEN];
+    uint32_t count;
+    uint32_t total_us;
+} profile_t;
+
+static profile_t profile[TEST_HELPERS_PROFILE_NUMOF];
+#endif
 
 #ifdef JSON_SHELL_PARSER
 static int parser_state[NUM_OF_JSON_SHELL_PARSER] = {0};
 #endif
 
+#ifdef BIN_SHELL_PARSER
+static int parser_state[NUM_OF_BIN_SHELL_PARSER] = {0};
+#endif
+
+static outbuf_t *_get_outbuf(int dev)
+{
+#if defined(JSON_SHELL_PARSER) || defined(BIN_SHELL_PARSER)
+    assert((unsigned)dev < OUTBUF_NUMOF);
+    return &outbuf[dev];
+#else
+    (void)dev;
+    return &outbuf[0];
+#endif
+}
+
+/* outbuf and parser_state of dev belong to the calling thread until the
+ * result of its response is written */
+static void _lock(int dev)
+{
+    outbuf_t *out = _get_outbuf(dev);
+    kernel_pid_t pid = thread_getpid();
+
+    /* only the calling thread can set the owner to its own pid */
+    if (out->owner != pid) {
+        mutex_lock(&out->lock);
+        out->owner = pid;
+    }
+}
+
+static void _unlock(int dev)
+{
+    outbuf_t *out = _get_outbuf(dev);
+
+    out->owner = KERNEL_PID_UNDEF;
+    mutex_unlock(&out->lock);
+}
+
+void test_helpers_stdout_lock(void)
+{
+    rmutex_lock(&stdout_lock);
+}
+
+void test_helpers_stdout_unlock(void)
+{
+    rmutex_unlock(&stdout_lock);
+}
+
+uint16_t test_helpers_crc16(uint16_t crc, const uint8_t *buf, size_t len)
+{
+    while (len--) {
+        crc ^= (uint16_t)(*buf++) << 8;
+        for (unsigned i = 0; i < 8; i++) {
+            crc = (crc & 0x8000) ? (crc << 1) ^ CRC16_CCITT_POLY : (crc << 1);
+        }
+    }
+    return crc;
+}
+
+static void _flush(int dev, bool last)
+{
+    outbuf_t *out = _get_outbuf(dev);
+
+    /* responses that do not fit the buffer are written in several parts */
+    if (!out->flushing) {
+        rmutex_lock(&stdout_lock);
+        out->flushing = true;
+    }
+
+#ifdef BIN_SHELL_PARSER
+    uint8_t *frame = (uint8_t *)out->buf;
+    frame[0] = BIN_FRAME_SOF;
+    frame[1] = last ? BIN_FRAME_FLAG_LAST : 0;
+    frame[2] = (uint8_t)out->len;
+    frame[3] = (uint8_t)(out->len >> 8);
+    uint16_t crc = test_helpers_crc16(TEST_HELPERS_CRC16_INIT, &frame[1],
+                                      BIN_FRAME_HDR_LEN - 1 + out->len);
+    frame[BIN_FRAME_HDR_LEN + out->len] = (uint8_t)crc;
+    frame[BIN_FRAME_HDR_LEN + out->len + 1] = (uint8_t)(crc >> 8);
+    fwrite(out->buf, 1, OUTBUF_HDR_LEN + out->len + OUTBUF_CRC_LEN, stdout);
+    fflush(stdout);
+    out->len = 0;
+#else
+    if (out->len) {
+        fwrite(out->buf, 1, out->len, stdout);
+        fflush(stdout);
+        out->len = 0;
+    }
+#endif
+    if (last) {
+        out->flushing = false;
+        rmutex_unlock(&stdout_lock);
+    }
+}
+
+static void _write(int dev, const char *data, size_t len)
+{
+    outbuf_t *out = _get_outbuf(dev);
+
+    while (len) {
+        size_t n = TEST_HELPERS_BUFSIZE - out->len;
+        if (n == 0) {
+            _flush(dev, false);
+            continue;
+        }
+        if (n > len) {
+            n = len;
+        }
+        memcpy(&out->buf[OUTBUF_HDR_LEN + out->len], data, n);
+        out->len += n;
+        data += n;
+        len -= n;
+    }
+}
+
+#ifndef BIN_SHELL_PARSER
+static void _write_str(int dev, const char *str)
+{
+    _write(dev, str, strlen(str));
+}
+
+static void _write_s32(int dev, int32_t val)
+{
+    /* fits "-2147483648" */
+    char tmp[11];
+    _write(dev, tmp, fmt_s32_dec(tmp, val));
+}
+
+static void _write_u32(int dev, uint32_t val)
+{
+    /* fits "4294967295" */
+    char tmp[10];
+    _write(dev, tmp, fmt_u32_dec(tmp, val));
+}
+
+static void _write_hex(int dev, const uint8_t *data, size_t len)
+{
+    /* convert in chunks to keep the stack usage low */
+    char tmp[32];
+    while (len) {
+        size_t n = (len > sizeof(tmp) / 2) ? sizeof(tmp) / 2 : len;
+        _write(dev, tmp, fmt_bytes_hex(tmp, data, n));
+        data += n;
+        len -= n;
+    }
+}
+#endif
+
 #ifdef JSON_SHELL_PARSER
 static void _start_json(int dev) {
     if (parser_state[dev] == JSON_STATE_READY) {
-        printf("{");
+        outbuf_t *out = _get_outbuf(dev);
+        if (out->nested && out->nested_count++) {
+            _write_str(dev, ",");
+        }
+        _write_str(dev, "{");
         parser_state[dev] |= JSON_STATE_STARTED;
     }
     else {
-        printf(",");
+        _write_str(dev, ",");
     }
 }
+
+static void _start_json_data(int dev)
+{
+    _start_json(dev);
+    if (!(parser_state[dev] & JSON_STATE_DATA_STARTED))
+    {
+        _write_str(dev, "\"data\":[");
+        parser_state[dev] |= JSON_STATE_DATA_STARTED;
+    }
+}
+#endif
+
+#ifdef BIN_SHELL_PARSER
+static void _write_cbor_head(int dev, uint8_t type, uint32_t val)
+{
+    uint8_t head[5];
+    size_t len;
+
+    if (val < 24) {
+        head[0] = type | (uint8_t)val;
+        len = 1;
+    }
+    else if (val <= UINT8_MAX) {
+        head[0] = type | 24;
+        head[1] = (uint8_t)val;
+        len = 2;
+    }
+    else if (val <= UINT16_MAX) {
+        head[0] = type | 25;
+        head[1] = (uint8_t)(val >> 8);
+        head[2] = (uint8_t)val;
+        len = 3;
+    }
+    else {
+        head[0] = type | 26;
+        head[1] = (uint8_t)(val >> 24);
+        head[2] = (uint8_t)(val >> 16);
+        head[3] = (uint8_t)(val >> 8);
+        head[4] = (uint8_t)val;
+        len = 5;
+    }
+    _write(dev, (char *)head, len);
+}
+
+static void _write_cbor_simple(int dev, uint8_t val)
+{
+    _write(dev, (char *)&val, 1);
+}
+
+static void _write_cbor_int(int dev, int32_t val)
+{
+    if (val < 0) {
+        _write_cbor_head(dev, CBOR_NINT, (uint32_t)(-1 - val));
+    }
+    else {
+        _write_cbor_head(dev, CBOR_UINT, (uint32_t)val);
+    }
+}
+
+static void _write_cbor_text(int dev, const char *str)
+{
+    size_t len = strlen(str);
+    _write_cbor_head(dev, CBOR_TEXT, len);
+    _write(dev, str, len);
+}
+
+static void _start_bin(int dev)
+{
+    if (parser_state[dev] == BIN_STATE_READY) {
+        _write_cbor_simple(dev, CBOR_MAP | CBOR_INDEFINITE);
+        parser_state[dev] |= BIN_STATE_STARTED;
+    }
+}
+
+static void _start_bin_data(int dev)
+{
+    _start_bin(dev);
+    if (!(parser_state[dev] & BIN_STATE_DATA_STARTED)) {
+        _write_cbor_text(dev, "data");
+        _write_cbor_simple(dev, CBOR_ARRAY | CBOR_INDEFINITE);
+        parser_state[dev] |= BIN_STATE_DATA_STARTED;
+    }
+}
+#endif
+
+#ifdef TEST_HELPERS_DURATION
+static void _start_duration(int dev, const char *cmd)
+{
+    outbuf_t *out = _get_outbuf(dev);
+
+    /* the name is the part of the command before its arguments */
+    size_t len = strcspn(cmd, "( ");
+    if (len >= sizeof(out->cmd)) {
+        len = sizeof(out->cmd) - 1;
+    }
+    memcpy(out->cmd, cmd, len);
+    out->cmd[len] = '\0';
+    out->start_us = xtimer_now_usec();
+}
+
+static bool _end_duration(int dev, uint32_t *duration)
+{
+    outbuf_t *out = _get_outbuf(dev);
+
+    /* results that are printed without a command are not timed */
+    if (out->cmd[0] == '\0') {
+        return false;
+    }
+    *duration = xtimer_now_usec() - out->start_us;
+    out->cmd[0] = '\0';
+    return true;
+}
+
+static void _profile_add(const char *name, uint32_t duration)
+{
+    for (unsigned i = 0; i < TEST_HELPERS_PROFILE_NUMOF; i++) {
+        profile_t *entry = &profile[i];
+        /* unused entries are taken in order, so the first empty one ends
+         * the search */
+        if (entry->name[0] == '\0') {
+            strncpy(entry->name, name, sizeof(entry->name) - 1);
+        }
+        if (strncmp(entry->name, name, sizeof(entry->name) - 1) == 0) {
+            entry->count++;
+            entry->total_us += duration;
+            break;
+        }
+    }
+}
+
+int test_helperstest_helpers_profile_call(const shell_command_t *cmd, int argc, char **argv)
+{
+    uint32_t start = xtimer_now_usec();
+    int res = cmd->handler(argc, argv);
+    _profile_add(cmd->name, xtimer_now_usec() - start);
+    return res;
+}
 #endif
 
 void print_cmd(int dev, char *cmd)
 {
-#ifdef JSON_SHELL_PARSER
+    _lock(dev);
+#ifdef TEST_HELPERS_DURATION
+    _start_duration(dev, cmd);
+#endif
+#if defined(JSON_SHELL_PARSER)
     _start_json(dev);
     assert(!(parser_state[dev] & JSON_STATE_DATA_STARTED));
-    printf("\"cmd\":\"%s\"", cmd);
+    _write_str(dev, "\"cmd\":\"");
+    _write_str(dev, cmd);
+    _write_str(dev, "\"");
+    if (dev && !_get_outbuf(dev)->nested) {
+        _write_str(dev, ",\"dev\":");
+        _write_s32(dev, dev);
+    }
+#elif defined(BIN_SHELL_PARSER)
+    _start_bin(dev);
+    assert(!(parser_state[dev] & BIN_STATE_DATA_STARTED));
+    _write_cbor_text(dev, "cmd");
+    _write_cbor_text(dev, cmd);
+    if (dev && !_get_outbuf(dev)->nested) {
+        _write_cbor_text(dev, "dev");
+        _write_cbor_int(dev, dev);
+    }
 #else
-    (void)dev;
-    puts(cmd);
+    _write_str(dev, cmd);
+    _write_str(dev, "\n");
 #endif
 }
 
 void print_data_dict_str(int dev, char *key, char *val)
 {
-#ifdef JSON_SHELL_PARSER
-    _start_json(dev);
-    if (!(parser_state[dev] & JSON_STATE_DATA_STARTED))
-    {
-        printf("\"data\":[");
-        parser_state[dev] |= JSON_STATE_DATA_STARTED;
-    }
-    printf("{\"%s\":\"%s\"}", key, val);
+    _lock(dev);
+#if defined(JSON_SHELL_PARSER)
+    _start_json_data(dev);
+    _write_str(dev, "{\"");
+    _write_str(dev, key);
+    _write_str(dev, "\":\"");
+    _write_str(dev, val);
+    _write_str(dev, "\"}");
+#elif defined(BIN_SHELL_PARSER)
+    _start_bin_data(dev);
+    _write_cbor_head(dev, CBOR_MAP, 1);
+    _write_cbor_text(dev, key);
+    _write_cbor_text(dev, val);
 #else
-    (void)dev;
-    printf("%s: %s\n", key, val);
+    _write_str(dev, key);
+    _write_str(dev, ": ");
+    _write_str(dev, val);
+    _write_str(dev, "\n");
+#endif
+}
+
+void print_data_dict_int(int dev, char *key, int32_t val)
+{
+    _lock(dev);
+#if defined(JSON_SHELL_PARSER)
+    _start_json_data(dev);
+    _write_str(dev, "{\"");
+    _write_str(dev, key);
+    _write_str(dev, "\":");
+    _write_s32(dev, val);
+    _write_str(dev, "}");
+#elif defined(BIN_SHELL_PARSER)
+    _start_bin_data(dev);
+    _write_cbor_head(dev, CBOR_MAP, 1);
+    _write_cbor_text(dev, key);
+    _write_cbor_int(dev, val);
+#else
+    _write_str(dev, key);
+    _write_str(dev, ": ");
+    _write_s32(dev, val);
+    _write_str(dev, "\n");
 #endif
 }
 
 void print_data_int(int dev, int32_t data)
 {
-#ifdef JSON_SHELL_PARSER
-    _start_json(dev);
-    if (!(parser_state[dev] & JSON_STATE_DATA_STARTED))
-    {
-        printf("\"data\":[");
-        parser_state[dev] |= JSON_STATE_DATA_STARTED;
-    }
-    printf("%" PRIi32, data);
+    _lock(dev);
+#if defined(JSON_SHELL_PARSER)
+    _start_json_data(dev);
+    _write_s32(dev, data);
+#elif defined(BIN_SHELL_PARSER)
+    _start_bin_data(dev);
+    _write_cbor_int(dev, data);
 #else
-    (void)dev;
-    printf("%" PRIi32 "\n", data);
+    _write_s32(dev, data);
+    _write_str(dev, "\n");
 #endif
 }
 
 void print_data_str(int dev, char *str)
 {
-#ifdef JSON_SHELL_PARSER
-    _start_json(dev);
-    if (!(parser_state[dev] & JSON_STATE_DATA_STARTED))
-    {
-        printf("\"data\":[");
-        parser_state[dev] |= JSON_STATE_DATA_STARTED;
+    _lock(dev);
+#if defined(JSON_SHELL_PARSER)
+    _start_json_data(dev);
+    _write_str(dev, "\"");
+    _write_str(dev, str);
+    _write_str(dev, "\"");
+#elif defined(BIN_SHELL_PARSER)
+    _start_bin_data(dev);
+    _write_cbor_text(dev, str);
+#else
+    _write_str(dev, str);
+    _write_str(dev, "\n");
+#endif
+}
+
+static void _start_array(int dev, size_t len)
+{
+#if defined(JSON_SHELL_PARSER)
+    (void)len;
+    _start_json_data(dev);
+    _write_str(dev, "[");
+#elif defined(BIN_SHELL_PARSER)
+    _start_bin_data(dev);
+    _write_cbor_head(dev, CBOR_ARRAY, len);
+#else
+    (void)dev;
+    (void)len;
+#endif
+}
+
+static void _start_array_elem(int dev, size_t idx)
+{
+#if defined(JSON_SHELL_PARSER)
+    if (idx) {
+        _write_str(dev, ",");
     }
-    printf("\"%s\"", str);
+#elif defined(BIN_SHELL_PARSER)
+    (void)dev;
+    (void)idx;
 #else
+    if (idx) {
+        _write_str(dev, " ");
+    }
+#endif
+}
+
+static void _end_array(int dev)
+{
+#if defined(JSON_SHELL_PARSER)
+    _write_str(dev, "]");
+#elif defined(BIN_SHELL_PARSER)
     (void)dev;
-    puts(str);
+#else
+    _write_str(dev, "\n");
+#endif
+}
+
+static void _write_array_s32(int dev, int32_t val)
+{
+#ifdef BIN_SHELL_PARSER
+    _write_cbor_int(dev, val);
+#else
+    _write_s32(dev, val);
+#endif
+}
+
+static void _write_array_u32(int dev, uint32_t val)
+{
+#ifdef BIN_SHELL_PARSER
+    _write_cbor_head(dev, CBOR_UINT, val);
+#else
+    _write_u32(dev, val);
+#endif
+}
+
+void print_data_bytes(int dev, const uint8_t *data, size_t len)
+{
+    _lock(dev);
+#if defined(JSON_SHELL_PARSER)
+    _start_json_data(dev);
+    _write_str(dev, "\"");
+    _write_hex(dev, data, len);
+    _write_str(dev, "\"");
+#elif defined(BIN_SHELL_PARSER)
+    _start_bin_data(dev);
+    _write_cbor_head(dev, CBOR_BYTES, len);
+    _write(dev, (const char *)data, len);
+#else
+    _write_hex(dev, data, len);
+    _write_str(dev, "\n");
 #endif
 }
 
+void print_data_int_array(int dev, const int32_t *data, size_t len)
+{
+    _lock(dev);
+    _start_array(dev, len);
+    for (size_t i = 0; i < len; i++) {
+        _start_array_elem(dev, i);
+        _write_array_s32(dev, data[i]);
+    }
+    _end_array(dev);
+}
+
+void print_data_u16_array(int dev, const uint16_t *data, size_t len)
+{
+    _lock(dev);
+    _start_array(dev, len);
+    for (size_t i = 0; i < len; i++) {
+        _start_array_elem(dev, i);
+        _write_array_u32(dev, data[i]);
+    }
+    _end_array(dev);
+}
+
+void print_data_u32_array(int dev, const uint32_t *data, size_t len)
+{
+    _lock(dev);
+    _start_array(dev, len);
+    for (size_t i = 0; i < len; i++) {
+        _start_array_elem(dev, i);
+        _write_array_u32(dev, data[i]);
+    }
+    _end_array(dev);
+}
+
 void print_result(int dev, char *res)
 {
-#ifdef JSON_SHELL_PARSER
+    outbuf_t *out = _get_outbuf(dev);
+
+    _lock(dev);
+    if (out->nested && strcmp(res, TEST_RESULT_SUCCESS)) {
+        out->nested_error = true;
+    }
+#ifdef TEST_HELPERS_DURATION
+    uint32_t duration;
+    bool timed = _end_duration(dev, &duration);
+#endif
+#if defined(JSON_SHELL_PARSER)
     if ((parser_state[dev] & JSON_STATE_DATA_STARTED))
     {
-        printf("]");
+        _write_str(dev, "]");
         parser_state[dev] &= ~JSON_STATE_DATA_STARTED;
     }
+#ifdef TEST_HELPERS_DURATION
+    if (timed) {
+        _start_json(dev);
+        _write_str(dev, "\"duration_us\":");
+        _write_u32(dev, duration);
+    }
+#endif
     _start_json(dev);
-    printf("\"result\":\"%s\"}\n", res);
+    _write_str(dev, "\"result\":\"");
+    _write_str(dev, res);
+    _write_str(dev, out->nested ? "\"}" : "\"}\n");
     parser_state[dev] &= ~JSON_STATE_STARTED;
+#elif defined(BIN_SHELL_PARSER)
+    if ((parser_state[dev] & BIN_STATE_DATA_STARTED)) {
+        _write_cbor_simple(dev, CBOR_BREAK);
+        parser_state[dev] &= ~BIN_STATE_DATA_STARTED;
+    }
+    _start_bin(dev);
+#ifdef TEST_HELPERS_DURATION
+    if (timed) {
+        _write_cbor_text(dev, "duration_us");
+        _write_cbor_head(dev, CBOR_UINT, duration);
+    }
+#endif
+    _write_cbor_text(dev, "result");
+    _write_cbor_text(dev, res);
+    _write_cbor_simple(dev, CBOR_BREAK);
+    parser_state[dev] &= ~BIN_STATE_STARTED;
 #else
-    (void)dev;
-    puts(res);
+#ifdef TEST_HELPERS_DURATION
+    if (timed) {
+        _write_str(dev, "duration_us: ");
+        _write_u32(dev, duration);
+        _write_str(dev, "\n");
+    }
+#endif
+    _write_str(dev, res);
+    _write_str(dev, "\n");
 #endif
+    if (!out->nested) {
+        _flush(dev, true);
+        _unlock(dev);
+    }
 }
+
+static int _batch_run(int dev, const shell_command_t *cmds,
+                      int argc, char **argv)
+{
+    for (; cmds->name != NULL; cmds++) {
+        if (strcmp(cmds->name, argv[0]) == 0) {
+            break;
+        }
+    }
+    if (cmds->name == NULL) {
+        print_cmd(dev, argv[0]);
+        print_result(dev, TEST_RESULT_ERROR);
+        return -1;
+    }
+
+#ifdef TEST_HELPERS_DURATION
+    int res = test_helpers_profile_call(cmds, argc, argv);
+#else
+    int res = cmds->handler(argc, argv);
+#endif
+
+#if defined(JSON_SHELL_PARSER) || defined(BIN_SHELL_PARSER)
+    /* close the response if the command did not print a result */
+    if (parser_state[dev] != 0) {
+        print_result(dev, res ? TEST_RESULT_ERROR : TEST_RESULT_SUCCESS);
+    }
+#endif
+    if (res) {
+        _get_outbuf(dev)->nested_error = true;
+    }
+    return res;
+}
+
+int test_helpers_batch(int dev, const shell_command_t *cmds,
+                       int argc, char **argv)
+{
+    outbuf_t *out = _get_outbuf(dev);
+    bool stop_on_error = false;
+    int i = 1;
+
+    _lock(dev);
+    if (i < argc && strcmp(argv[i], "-e") == 0) {
+        stop_on_error = true;
+        i++;
+    }
+    if (out->nested || i >= argc) {
+        print_cmd(dev, "batch()");
+        print_data_str(dev, TEST_HELPERS_BATCH_USAGE);
+        print_result(dev, TEST_RESULT_ERROR);
+        return -1;
+    }
+
+    print_cmd(dev, stop_on_error ? "batch(stop_on_error=1)"
+                                 : "batch(stop_on_error=0)");
+#if defined(JSON_SHELL_PARSER)
+    _start_json_data(dev);
+    int state = parser_state[dev];
+    parser_state[dev] = JSON_STATE_READY;
+#elif defined(BIN_SHELL_PARSER)
+    _start_bin_data(dev);
+    int state = parser_state[dev];
+    parser_state[dev] = BIN_STATE_READY;
+#endif
+#ifdef TEST_HELPERS_DURATION
+    /* the nested commands are timed on their own */
+    char cmd[TEST_HELPERS_CMD_NAME_LEN];
+    memcpy(cmd, out->cmd, sizeof(cmd));
+    uint32_t start_us = out->start_us;
+#endif
+    out->nested = true;
+    out->nested_error = false;
+    out->nested_count = 0;
+
+    while (i < argc && !(stop_on_error && out->nested_error)) {
+        char **sub_argv = &argv[i];
+        int sub_argc = 0;
+
+        /* the separator is either a token of its own or ends a token */
+        while (i < argc) {
+            char *arg = argv[i++];
+            size_t len = strlen(arg);
+            if (len && arg[len - 1] == ';') {
+                arg[len - 1] = '\0';
+                sub_argc += (len > 1);
+                break;
+            }
+            sub_argc++;
+        }
+        if (sub_argc) {
+            _batch_run(dev, cmds, sub_argc, sub_argv);
+        }
+    }
+
+    out->nested = false;
+#if defined(JSON_SHELL_PARSER) || defined(BIN_SHELL_PARSER)
+    parser_state[dev] = state;
+#endif
+#ifdef TEST_HELPERS_DURATION
+    memcpy(out->cmd, cmd, sizeof(cmd));
+    out->start_us = start_us;
+#endif
+    print_result(dev, out->nested_error ? TEST_RESULT_ERROR
+                                        : TEST_RESULT_SUCCESS);
+    return out->nested_error ? -1 : 0;
+}
+
+static void _print_mem_key(int dev, const char *name, const char *suffix,
+                           int32_t val)
+{
+    char key[TEST_HELPERS_MEM_KEY_LEN];
+    size_t len = strlen(name);
+    size_t max = sizeof(key) - strlen(suffix) - 1;
+
+    if (len > max) {
+        len = max;
+    }
+    memcpy(key, name, len);
+    strcpy(&key[len], suffix);
+    print_data_dict_int(dev, key, val);
+}
+
+int test_helpers_mem_stats(int dev, const test_helpers_mem_buf_t *bufs,
+                           int argc, char **argv)
+{
+    (void)argv;
+    print_cmd(dev, "mem_stats()");
+    if (argc != 1) {
+        print_data_str(dev, TEST_HELPERS_MEM_STATS_USAGE);
+        print_result(dev, TEST_RESULT_ERROR);
+        return -1;
+    }
+
+#ifdef DEVELHELP
+    for (kernel_pid_t pid = KERNEL_PID_FIRST; pid <= KERNEL_PID_LAST; pid++) {
+        thread_t *thread = (thread_t *)thread_get(pid);
+        char pid_name[8];
+
+        if (thread == NULL) {
+            continue;
+        }
+        const char *name = thread->name;
+        if (name == NULL) {
+            strcpy(pid_name, "pid");
+            pid_name[3 + fmt_u32_dec(&pid_name[3], pid)] = '\0';
+            name = pid_name;
+        }
+        int unused = thread_measure_stack_free(thread->stack_start);
+        _print_mem_key(dev, name, "_stack_size", thread->stack_size);
+        _print_mem_key(dev, name, "_stack_used", thread->stack_size - unused);
+    }
+#ifdef ISR_STACKSIZE
+    print_data_dict_int(dev, "isr_stack_size", ISR_STACKSIZE);
+    print_data_dict_int(dev, "isr_stack_used", thread_isr_stack_usage());
+#endif
+#endif
+
+    size_t total = TEST_SCRATCH_SIZE;
+    print_data_dict_int(dev, "scratch_size", TEST_SCRATCH_SIZE);
+    print_data_dict_int(dev, "scratch_max_used", test_scratch_max_used());
+    for (; bufs && bufs->name; bufs++) {
+        _print_mem_key(dev, bufs->name, "_size", bufs->size);
+        total += bufs->size;
+    }
+    print_data_dict_int(dev, "static_total", total);
+    print_result(dev, TEST_RESULT_SUCCESS);
+    return 0;
+}
+
+#ifdef TEST_HELPERS_DURATION
+/* commands of the application behind the table of test_helpers_profile_commands */
+static const shell_command_t *profiled_cmds;
+static shell_command_t profiled_table[TEST_HELPERS_PROFILE_NUMOF + 1];
+
+static int _profile_handler(int argc, char **argv)
+{
+    for (const shell_command_t *cmd = profiled_cmds; cmd->name; cmd++) {
+        if (strcmp(cmd->name, argv[0]) == 0) {
+            return test_helpers_profile_call(cmd, argc, argv);
+        }
+    }
+    return -1;
+}
+
+const shell_command_t *test_helpers_profile_commands(const shell_command_t *cmds)
+{
+    unsigned num = 0;
+
+    while (cmds[num].name != NULL) {
+        if (++num > TEST_HELPERS_PROFILE_NUMOF) {
+            return cmds;
+        }
+    }
+    for (unsigned i = 0; i < num; i++) {
+        profiled_table[i] = cmds[i];
+        profiled_table[i].handler = _profile_handler;
+    }
+    profiled_cmds = cmds;
+    return profiled_table;
+}
+
+int test_helpers_profile(int dev, const shell_command_t *cmds,
+                         int argc, char **argv)
+{
+    bool reset = (argc > 1) && (strcmp(argv[1], "reset") == 0);
+
+    if ((argc > 2) || ((argc > 1) && !reset)) {
+        print_cmd(dev, "profile()");
+        print_data_str(dev, TEST_HELPERS_PROFILE_USAGE);
+        print_result(dev, TEST_RESULT_ERROR);
+        return -1;
+    }
+
+    print_cmd(dev, reset ? "profile(reset=1)" : "profile(reset=0)");
+    for (; cmds->name != NULL; cmds++) {
+        for (unsigned i = 0; i < TEST_HELPERS_PROFILE_NUMOF; i++) {
+            if (strncmp(profile[i].name, cmds->name,
+                        sizeof(profile[i].name) - 1) == 0) {
+                /* fits the name, "_count" and the terminator */
+                char key[TEST_HELPERS_CMD_NAME_LEN + 6];
+                strcpy(key, profile[i].name);
+                size_t len = strlen(key);
+                strcpy(&key[len], "_count");
+                print_data_dict_int(dev, key, profile[i].count);
+                strcpy(&key[len], "_us");
+                print_data_dict_int(dev, key, profile[i].total_us);
+                break;
+            }
+        }
+    }
+    print_result(dev, TEST_RESULT_SUCCESS);
+    if (reset) {
+        memset(profile, 0, sizeof(profile));
+    }
+    return 0;
+}
+#endif
+
+#ifdef TEST_HELPERS_STDIO_BAUD
+/* the receive pipe of stdio_uart, the confirmation is read from it */
+extern isrpipe_t stdio_uart_isrpipe;
+
+static uint32_t stdio_baud = STDIO_UART_BAUDRATE;
+
+static void _stdio_rx_cb(void *arg, uint8_t data)
+{
+    isrpipe_write_one(arg, (char)data);
+}
+
+static int _stdio_set_baud(uint32_t baud)
+{
+    return uart_init(STDIO_UART_DEV, baud, _stdio_rx_cb, &stdio_uart_isrpipe);
+}
+
+static bool _stdio_wait_confirm(uint32_t timeout_us)
+{
+    static const char confirm[] = TEST_HELPERS_STDIO_BAUD_CONFIRM;
+    uint32_t start = xtimer_now_usec();
+    size_t matched = 0;
+
+    while (1) {
+        uint32_t elapsed = xtimer_now_usec() - start;
+        char c;
+
+        if ((elapsed >= timeout_us) ||
+            (isrpipe_read_timeout(&stdio_uart_isrpipe, &c, 1,
+                                  timeout_us - elapsed) != 1)) {
+            return false;
+        }
+        if ((c == '\r') || (c == '\n')) {
+            if (matched == sizeof(confirm) - 1) {
+                return true;
+            }
+            matched = 0;
+        }
+        else if ((matched < sizeof(confirm) - 1) && (c == confirm[matched])) {
+            matched++;
+        }
+        else {
+            /* garbage received while the rates did not match yet */
+            matched = (c == confirm[0]) ? 1 : 0;
+        }
+    }
+}
+
+int test_helpers_stdio_baud(int dev, int argc, char **argv)
+{
+    uint32_t baud = 0;
+    uint32_t timeout_ms = TEST_HELPERS_STDIO_BAUD_TIMEOUT_MS;
+
+    if ((argc < 2) || (argc > 3) ||
+        (sc_arg2u32(argv[1], &baud) != ARGS_OK) || (baud == 0) ||
+        ((argc == 3) && (sc_arg2u32(argv[2], &timeout_ms) != ARGS_OK))) {
+        print_cmd(dev, "stdio_baud()");
+        print_data_str(dev, TEST_HELPERS_STDIO_BAUD_USAGE);
+        print_result(dev, TEST_RESULT_ERROR);
+        return -1;
+    }
+    if (_get_outbuf(dev)->nested) {
+        print_cmd(dev, "stdio_baud()");
+        print_data_str(dev, "stdio_baud is not supported in a batch");
+        print_result(dev, TEST_RESULT_ERROR);
+        return -1;
+    }
+
+    uint32_t old = stdio_baud;
+
+    print_cmd(dev, "stdio_baud()");
+    print_data_int(dev, (int32_t)baud);
+    print_result(dev, TEST_RESULT_SUCCESS);
+
+    /* let the response leave the UART at the old rate, the shell prompt
+     * only follows when the command returns */
+    xtimer_usleep((TEST_HELPERS_STDIO_BAUD_DRAIN * 10 * US_PER_SEC) / old);
+
+    if ((_stdio_set_baud(baud) == UART_OK) &&
+        _stdio_wait_confirm(timeout_ms * US_PER_MS)) {
+        stdio_baud = baud;
+        print_cmd(dev, "stdio_baud_confirm()");
+        print_data_int(dev, (int32_t)baud);
+        print_result(dev, TEST_RESULT_SUCCESS);
+        return 0;
+    }
+
+    /* the host did not confirm in time, fall back to the previous rate */
+    _stdio_set_baud(old);
+    print_cmd(dev, "stdio_baud_confirm()");
+    print_data_int(dev, (int32_t)old);
+    print_result(dev, TEST_RESULT_ERROR);
+    return -1;
+}
+
+int test_helpers_stdio_baud_cmd(int argc, char **argv)
+{
+    return test_helpers_stdio_baud(0, argc, argv);
+}
+#endif
@@ -0,0 +1,73 @@
+/*
+ * Copyright (C) 2019 HAW Hamburg
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+/**
+ * @ingroup tests
+ * @{
+ *
+ * @file
+ * @brief       Scratch arena the commands of the tests borrow buffers from.
+ *
+ * @}
+ */
+
+#include <assert.h>
+#include <stdint.h>
+
+#include "test_scratch.h"
+
+/* the union aligns the arena for any borrowed buffer */
+static union {
+    uint8_t bytes[TEST_SCRATCH_SIZE];
+    void *align;
+} arena;
+
+static size_t used;
+static size_t max_used;
+
+void *test_scratch_alloc(size_t len)
+{
+    size_t start = (used + TEST_SCRATCH_ALIGN - 1) & ~(TEST_SCRATCH_ALIGN - 1);
+
+    if (start > TEST_SCRATCH_SIZE || len > TEST_SCRATCH_SIZE - start) {
+        return NULL;
+    }
+    used = start + len;
+    if (used > max_used) {
+        max_used = used;
+    }
+    return &arena.bytes[start];
+}
+
+size_t test_scratch_mark(void)
+{
+    return used;
+}
+
+void test_scratch_release(size_t mark)
+{
+    assert(mark <= used);
+    used = mark;
+}
+
+void test_scratch_reset(void)
+{
+    used = 0;
+}
+
+size_t test_scratch_available(void)
+{
+    size_t start = (used + TEST_SCRATCH_ALIGN - 1) & ~(TEST_SCRATCH_ALIGN - 1);
+
+    return (start < TEST_SCRATCH_SIZE) ? TEST_SCRATCH_SIZE - start : 0;
+}
+
+size_t test_scratch_max_used(void)
+{
+    return max_used;
+}
@@ -0,0 +1,108 @@
+/*
+ * Copyright (C) 2019 HAW Hamburg
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+/**
+ * @ingroup tests
+ * @{
+ *
+ * @file
+ * @brief       Simple statistics for benchmark commands of the tests.
+ *
+ * @}
+ */
+
+#include <string.h>
+
+#include "test_helpers.h"
+#include "test_stats.h"
+
+/* longest key is the prefix followed by "_stddev" */
+#define STATS_KEY_MAXLEN    (32U)
+
+void test_stats_init(test_stats_t *stats)
+{
+    memset(stats, 0, sizeof(*stats));
+    stats->min = INT32_MAX;
+    stats->max = INT32_MIN;
+}
+
+void test_stats_add(test_stats_t *stats, int32_t val)
+{
+    stats->count++;
+    stats->sum += val;
+    stats->sum_sq += (uint64_t)((int64_t)val * val);
+    if (val < stats->min) {
+        stats->min = val;
+    }
+    if (val > stats->max) {
+        stats->max = val;
+    }
+}
+
+int32_t test_stats_mean(const test_stats_t *stats)
+{
+    if (stats->count == 0) {
+        return 0;
+    }
+    return (int32_t)(stats->sum / (int64_t)stats->count);
+}
+
+static uint32_t _isqrt(uint64_t val)
+{
+    uint64_t res = 0;
+    uint64_t bit = (uint64_t)1 << 62;
+
+    while (bit > val) {
+        bit >>= 2;
+    }
+    while (bit) {
+        if (val >= res + bit) {
+            val -= res + bit;
+            res = (res >> 1) + bit;
+        }
+        else {
+            res >>= 1;
+        }
+        bit >>= 2;
+    }
+    return (uint32_t)res;
+}
+
+uint32_t test_stats_stddev(const test_stats_t *stats)
+{
+    if (stats->count == 0) {
+        return 0;
+    }
+    int64_t mean = stats->sum / (int64_t)stats->count;
+    uint64_t mean_sq = stats->sum_sq / stats->count;
+    uint64_t sq = (uint64_t)(mean * mean);
+    return (mean_sq > sq) ? _isqrt(mean_sq - sq) : 0;
+}
+
+static void _print_stat(int dev, const char *prefix, const char *name,
+                        int32_t val)
+{
+    char key[STATS_KEY_MAXLEN];
+    size_t len = strlen(prefix);
+
+    if (len > sizeof(key) - sizeof("_stddev")) {
+        len = sizeof(key) - sizeof("_stddev");
+    }
+    memcpy(key, prefix, len);
+    strcpy(&key[len], name);
+    print_data_dict_int(dev, key, val);
+}
+
+void print_data_stats(int dev, const char *prefix, const test_stats_t *stats)
+{
+    _print_stat(dev, prefix, "_count", (int32_t)stats->count);
+    _print_stat(dev, prefix, "_min", stats->count ? stats->min : 0);
+    _print_stat(dev, prefix, "_max", stats->count ? stats->max : 0);
+    _print_stat(dev, prefix, "_mean", test_stats_mean(stats));
+    _print_stat(dev, prefix, "_stddev", (int32_t)test_stats_stddev(stats));
+}
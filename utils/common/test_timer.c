@@ -0,0 +1,121 @@
+/*
+ * Copyright (C) 2019 HAW Hamburg
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+/**
+ * @ingroup tests
+ * @{
+ *
+ * @file
+ * @brief       Width of the periph_timer counters for the timer tests.
+ *
+ * @}
+ */
+
+#ifdef MODULE_PERIPH_TIMER
+
+#include "sc_args.h"
+#include "test_helpers.h"
+#include "test_timer.h"
+
+/* reads without a change of the counter before a timer counts as stopped */
+#define TIMER_WIDTH_STUCK   (0x100000UL)
+
+/* width of each timer in bit, 0 if it was never set */
+static uint8_t timer_width[TIMER_NUMOF];
+
+uint32_t test_timer_ticks_diff(tim_t dev, uint32_t a, uint32_t b)
+{
+    unsigned width = ((unsigned)dev < TIMER_NUMOF) ? timer_width[dev] : 0;
+
+#ifdef TEST_TIMER_WIDTH
+    if (width == 0) {
+        width = TEST_TIMER_WIDTH;
+    }
+#endif
+    if ((width == 0) || (width >= 32)) {
+        return b - a;
+    }
+    return (b - a) & ((1UL << width) - 1);
+}
+
+#ifndef TEST_TIMER_WIDTH
+/* width of the highest value of a running timer before it wraps, 0 if the
+ * counter does not change */
+static unsigned _timer_measure_width(tim_t dev)
+{
+    uint32_t prev = timer_read(dev);
+    uint32_t highest = prev;
+    uint32_t elapsed = 0;
+    uint32_t stuck = 0;
+
+    while (elapsed < TEST_TIMER_WIDTH_LIMIT) {
+        uint32_t now = timer_read(dev);
+        if (now < prev) {
+            break;
+        }
+        if (now == prev) {
+            if (++stuck >= TIMER_WIDTH_STUCK) {
+                return 0;
+            }
+            continue;
+        }
+        stuck = 0;
+        elapsed += now - prev;
+        highest = now;
+        prev = now;
+    }
+    if (elapsed >= TEST_TIMER_WIDTH_LIMIT) {
+        return 32;
+    }
+
+    unsigned width = 1;
+    while ((width < 32) && (highest >> width)) {
+        width++;
+    }
+    return width;
+}
+#endif
+
+int test_timer_width(int dev, int argc, char **argv)
+{
+    int tim = -1;
+    uint32_t width = 0;
+
+    if ((argc >= 2) && (argc <= 3)) {
+        tim = sc_arg2dev(argv[1], TIMER_NUMOF);
+    }
+    if ((tim < 0) ||
+        ((argc == 3) && ((sc_arg2u32(argv[2], &width) != ARGS_OK) ||
+                         (width == 0) || (width > 32)))) {
+        print_cmd(dev, "timer_width()");
+        print_data_str(dev, TEST_TIMER_WIDTH_USAGE);
+        print_result(dev, TEST_RESULT_ERROR);
+        return -1;
+    }
+
+    if (argc == 2) {
+#ifdef TEST_TIMER_WIDTH
+        /* the board config knows the width, no need to wait for a wrap */
+        width = TEST_TIMER_WIDTH;
+#else
+        width = _timer_measure_width(TIMER_DEV(tim));
+#endif
+    }
+    print_cmd(dev, "timer_width()");
+    if (width == 0) {
+        print_data_str(dev, "timer does not count, run timer_init first");
+        print_result(dev, TEST_RESULT_ERROR);
+        return -1;
+    }
+    timer_width[tim] = width;
+    print_data_int(dev, (int32_t)width);
+    print_result(dev, TEST_RESULT_SUCCESS);
+    return 0;
+}
+
+#endif /* MODULE_PERIPH_TIMER */
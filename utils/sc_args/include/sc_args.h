@@ -1,6 +1,9 @@
 #ifndef SHELL_ARGS_H
 #define SHELL_ARGS_H
 
+#include <stddef.h>
+#include <stdint.h>
+
 #define CONVERT_ERROR   (-32768)
 
 #define ARGS_OK     (0)
@@ -26,4 +29,33 @@ int sc_arg2u8(const char *arg, uint8_t *val);
 
 int sc_arg2dev(const char *arg, unsigned maxdev);
 
+/* parses a byte or a "0x" prefixed hex string of several bytes into buf,
+ * returns the number of bytes or ARGS_ERROR if they do not fit into maxlen */
+int sc_arg2bytes(const char *arg, uint8_t *buf, size_t maxlen);
+
+/* Parses all arguments after argv[0] in one pass as described by spec, a list
+ * of types separated by spaces or commas. The types after a '|' are
+ * optional. Each type takes the given arguments of the call:
+ *
+ *   dev    unsigned maxdev, int *dev     device number below maxdev
+ *   int    int *
+ *   uint   unsigned *
+ *   s32    int32_t *
+ *   u32    uint32_t *
+ *   u16    uint16_t *
+ *   u8     uint8_t *
+ *   str    const char **                 the argument itself
+ *   bytes  uint8_t *buf, size_t *len     all remaining arguments, each a
+ *                                        byte or a "0x" prefixed hex string,
+ *                                        *len is the size of buf and is set
+ *                                        to the number of bytes parsed
+ *
+ * Numbers out of range of their type are rejected.
+ * Returns the number of arguments parsed or ARGS_ERROR, e.g.
+ *
+ *   sc_args_parse(argc, argv, "dev, s32, s32 | u8", SPI_NUMOF, &dev,
+ *                 &port, &pin, &val)
+ */
+int sc_args_parse(int argc, char **argv, const char *spec, ...);
+
 #endif /* SHELL_ARGS_H */
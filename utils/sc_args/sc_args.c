@@ -19,11 +19,13 @@
  */
 
 #include <assert.h>
-#include <errno.h>
 #include <inttypes.h>
 #include <limits.h>
+#include <stdarg.h>
+#include <stdbool.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 
 #include "shell.h"
 #include "sc_args.h"
@@ -40,19 +42,69 @@ int sc_args_check(int argc, char **argv, int c_min, int c_max, char *use)
     return ARGS_OK;
 }
 
-int sc_arg2long(const char *arg, long *val)
+static int _hex2nibble(char c)
+{
+    if (c >= '0' && c <= '9') {
+        return c - '0';
+    }
+    if (c >= 'a' && c <= 'f') {
+        return c - 'a' + 10;
+    }
+    if (c >= 'A' && c <= 'F') {
+        return c - 'A' + 10;
+    }
+    return ARGS_ERROR;
+}
+
+/* Accepts the same decimal, "0x" hex and "0" octal numbers as strtoul()
+ * with base 0, but without its locale and errno handling. The magnitude is
+ * returned in val and a leading '-' in neg. */
+static int _arg2num(const char *arg, unsigned long *val, bool *neg)
 {
-    errno = 0;
-    char *end;
-    long res = strtol(arg, &end, 0);
+    unsigned base = 10;
 
-    if ((*end != '\0') || ((res == LONG_MIN || res == LONG_MAX) && errno == ERANGE)) {
+    *neg = (*arg == '-');
+    if (*arg == '-' || *arg == '+') {
+        arg++;
+    }
+    if (arg[0] == '0' && (arg[1] == 'x' || arg[1] == 'X')) {
+        base = 16;
+        arg += 2;
+    }
+    else if (arg[0] == '0' && arg[1] != '\0') {
+        base = 8;
+        arg++;
+    }
+    if (*arg == '\0') {
         return ARGS_ERROR;
     }
+
+    unsigned long res = 0;
+    for (; *arg != '\0'; arg++) {
+        int digit = _hex2nibble(*arg);
+        if (digit < 0 || (unsigned)digit >= base ||
+            res > (ULONG_MAX - digit) / base) {
+            return ARGS_ERROR;
+        }
+        res = res * base + digit;
+    }
     *val = res;
     return ARGS_OK;
 }
 
+int sc_arg2long(const char *arg, long *val)
+{
+    unsigned long res;
+    bool neg;
+
+    if (_arg2num(arg, &res, &neg) != ARGS_OK ||
+        res > (unsigned long)LONG_MAX + neg) {
+        return ARGS_ERROR;
+    }
+    *val = neg ? (long)(0UL - res) : (long)res;
+    return ARGS_OK;
+}
+
 int sc_arg2int(const char *arg, int *val)
 {
     long lval;
@@ -65,14 +117,14 @@ int sc_arg2int(const char *arg, int *val)
 
 int sc_arg2ulong(const char *arg, unsigned long *val)
 {
-    errno = 0;
-    char *end;
-    unsigned long res = strtoul(arg, &end, 0);
+    unsigned long res;
+    bool neg;
 
-    if ((*end != '\0') || (res == LONG_MAX && errno == ERANGE)) {
+    if (_arg2num(arg, &res, &neg) != ARGS_OK) {
         return ARGS_ERROR;
     }
-    *val = res;
+    /* like strtoul() a negative number wraps around */
+    *val = neg ? 0UL - res : res;
     return ARGS_OK;
 }
 
@@ -137,3 +189,177 @@ int sc_arg2dev(const char *arg, unsigned maxdev)
     }
     return dev;
 }
+
+int sc_arg2bytes(const char *arg, uint8_t *buf, size_t maxlen)
+{
+    if (arg[0] != '0' || (arg[1] != 'x' && arg[1] != 'X')) {
+        if (maxlen < 1 || sc_arg2u8(arg, buf) != ARGS_OK) {
+            return ARGS_ERROR;
+        }
+        return 1;
+    }
+
+    arg += 2;
+    size_t digits = strlen(arg);
+    /* an odd number of digits has an implicit leading zero */
+    size_t len = (digits + 1) / 2;
+    if (digits == 0 || len > maxlen) {
+        return ARGS_ERROR;
+    }
+    for (size_t i = 0; i < len; i++) {
+        int hi = 0;
+        if (i || !(digits & 1)) {
+            hi = _hex2nibble(*arg++);
+        }
+        int lo = _hex2nibble(*arg++);
+        if (hi < 0 || lo < 0) {
+            return ARGS_ERROR;
+        }
+        buf[i] = (uint8_t)((hi << 4) | lo);
+    }
+    return (int)len;
+}
+
+/* gets the next type of a spec, returns its length or 0 at the end */
+static size_t _next_type(const char **spec, bool *optional)
+{
+    while (**spec == ' ' || **spec == ',' || **spec == '|') {
+        if (**spec == '|') {
+            *optional = true;
+        }
+        (*spec)++;
+    }
+    return strcspn(*spec, " ,|");
+}
+
+static bool _is_type(const char *type, size_t len, const char *name)
+{
+    return (strlen(name) == len) && (memcmp(type, name, len) == 0);
+}
+
+static int _parse_uint(const char *arg, unsigned long max, unsigned long *val)
+{
+    bool neg;
+    if (_arg2num(arg, val, &neg) != ARGS_OK || neg || *val > max) {
+        return ARGS_ERROR;
+    }
+    return ARGS_OK;
+}
+
+int sc_args_parse(int argc, char **argv, const char *spec, ...)
+{
+    va_list ap;
+    bool optional = false;
+    int i = 1;
+    int res = ARGS_OK;
+    size_t len;
+
+    va_start(ap, spec);
+    while (res == ARGS_OK && (len = _next_type(&spec, &optional)) != 0) {
+        const char *type = spec;
+        spec += len;
+
+        if (_is_type(type, len, "bytes")) {
+            uint8_t *buf = va_arg(ap, uint8_t *);
+            size_t *buf_len = va_arg(ap, size_t *);
+            size_t n = 0;
+            for (; i < argc; i++) {
+                int bytes = sc_arg2bytes(argv[i], &buf[n], *buf_len - n);
+                if (bytes == ARGS_ERROR) {
+                    res = ARGS_ERROR;
+                    break;
+                }
+                n += bytes;
+            }
+            *buf_len = n;
+            continue;
+        }
+
+        if (i >= argc) {
+            /* missing arguments are only allowed after the '|' */
+            if (!optional) {
+                res = ARGS_ERROR;
+            }
+            break;
+        }
+
+        const char *arg = argv[i++];
+        unsigned long val;
+        long lval;
+        /* the pointers are taken even on errors to keep ap in step, the
+         * value is only stored if it was parsed */
+        if (_is_type(type, len, "dev")) {
+            unsigned maxdev = va_arg(ap, unsigned);
+            int *dev = va_arg(ap, int *);
+            res = _parse_uint(arg, UINT_MAX, &val);
+            if (res == ARGS_OK && val >= maxdev) {
+                res = ARGS_ERROR;
+            }
+            if (res == ARGS_OK) {
+                *dev = (int)val;
+            }
+        }
+        else if (_is_type(type, len, "int")) {
+            int *ival = va_arg(ap, int *);
+            res = sc_arg2long(arg, &lval);
+            if (res == ARGS_OK && (lval < INT_MIN || lval > INT_MAX)) {
+                res = ARGS_ERROR;
+            }
+            if (res == ARGS_OK) {
+                *ival = (int)lval;
+            }
+        }
+        else if (_is_type(type, len, "s32")) {
+            int32_t *s32 = va_arg(ap, int32_t *);
+            res = sc_arg2long(arg, &lval);
+            if (res == ARGS_OK && (lval < INT32_MIN || lval > INT32_MAX)) {
+                res = ARGS_ERROR;
+            }
+            if (res == ARGS_OK) {
+                *s32 = (int32_t)lval;
+            }
+        }
+        else if (_is_type(type, len, "uint")) {
+            unsigned *uval = va_arg(ap, unsigned *);
+            res = _parse_uint(arg, UINT_MAX, &val);
+            if (res == ARGS_OK) {
+                *uval = (unsigned)val;
+            }
+        }
+        else if (_is_type(type, len, "u32")) {
+            uint32_t *u32 = va_arg(ap, uint32_t *);
+            res = _parse_uint(arg, UINT32_MAX, &val);
+            if (res == ARGS_OK) {
+                *u32 = (uint32_t)val;
+            }
+        }
+        else if (_is_type(type, len, "u16")) {
+            uint16_t *u16 = va_arg(ap, uint16_t *);
+            res = _parse_uint(arg, UINT16_MAX, &val);
+            if (res == ARGS_OK) {
+                *u16 = (uint16_t)val;
+            }
+        }
+        else if (_is_type(type, len, "u8")) {
+            uint8_t *u8 = va_arg(ap, uint8_t *);
+            res = _parse_uint(arg, UINT8_MAX, &val);
+            if (res == ARGS_OK) {
+                *u8 = (uint8_t)val;
+            }
+        }
+        else if (_is_type(type, len, "str")) {
+            *va_arg(ap, const char **) = arg;
+        }
+        else {
+            /* unknown type in the spec */
+            assert(0);
+            res = ARGS_ERROR;
+        }
+    }
+    va_end(ap);
+
+    if (res != ARGS_OK || i < argc) {
+        return ARGS_ERROR;
+    }
+    return i - 1;
+}